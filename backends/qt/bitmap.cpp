@@ -7,14 +7,49 @@
 #include <QImageReader>
 
 
+struct Bitmap_Proxy : public DC_Proxy
+{
+	int				fExports;
+};
+
+
+static bool
+isLocked(DC_Proxy *self)
+{
+	return (self->fDevice) && (self->fDevice->devType() == QInternal::Image);
+}
+
+
+static QPixmap *
+getPixmap(DC_Proxy *self)
+{
+	if (isLocked(self)) {
+		PyErr_SetString(PyExc_RuntimeError, "bitmap is locked");
+		return NULL;
+	}
+	return (QPixmap *)self->fDevice;
+}
+
+
+static QImage
+getImage(DC_Proxy *self)
+{
+	if (isLocked(self))
+		return *((QImage *)self->fDevice);
+	return ((QPixmap *)self->fDevice)->toImage();
+}
+
+
 static PyObject *
 _new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
-	DC_Proxy *self = ( DC_Proxy *)type->tp_alloc(type, 0);
+	Bitmap_Proxy *self = ( Bitmap_Proxy *)type->tp_alloc(type, 0);
 	if (self) {
 		self->fDevice = NULL;
 		self->fPainter = NULL;
 		self->fBaseTransform = NULL;
+		self->fState = NULL;
+		self->fExports = 0;
 	}
 	return (PyObject *)self;
 }
@@ -27,15 +62,17 @@ _init(DC_Proxy *self, PyObject *args, PyObject *kwds)
 	if (!PyArg_ParseTuple(args, "O&", convertSize, &size))
 		return -1;
 	
-	delete self->fPainter;
+	if (((Bitmap_Proxy *)self)->fExports > 0) {
+		PyErr_SetString(PyExc_BufferError, "bitmap pixels are being accessed");
+		return -1;
+	}
+	endDCPainter(self);
 	delete self->fDevice;
 	
 	QPixmap *pixmap = new QPixmap(size);
 	pixmap->fill(QColor(255,255,255,0));
 	self->fDevice = pixmap;
-	self->fPainter = new QPainter(pixmap);
-	self->fPainter->setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::NonCosmeticDefaultPen);
-	self->fPainter->translate(0.5, 0.5);
+	self->fPainter = NULL;
 	
 	return 0;
 }
@@ -44,33 +81,91 @@ _init(DC_Proxy *self, PyObject *args, PyObject *kwds)
 static void
 _dealloc(DC_Proxy *self)
 {
-	freeBitmapResources(self->fPainter, self->fDevice);
+	freeDCResources(self);
 	self->ob_type->tp_free((PyObject*)self);
 }
 
 
-SL_DEFINE_DC_METHOD(get_size, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+static int
+_getbuffer(Bitmap_Proxy *self, Py_buffer *view, int flags)
+{
+	if (!isLocked(self)) {
+		PyErr_SetString(PyExc_BufferError, "bitmap must be locked to access its pixels");
+		view->obj = NULL;
+		return -1;
+	}
+	endDCPainter(self);
+	
+	QImage *image = (QImage *)self->fDevice;
+	if (PyBuffer_FillInfo(view, (PyObject *)self, image->bits(), image->bytesPerLine() * image->height(), 0, flags) < 0)
+		return -1;
 	
-	return createVectorObject(pixmap->size());
+	// rows of ARGB32 pixels, laid out as B, G, R, A bytes on little endian machines
+	if (flags & PyBUF_ND) {
+		Py_ssize_t *dims = (Py_ssize_t *)PyMem_Malloc(sizeof(Py_ssize_t) * 6);
+		if (!dims) {
+			Py_CLEAR(view->obj);
+			PyErr_NoMemory();
+			return -1;
+		}
+		dims[0] = image->height();
+		dims[1] = image->width();
+		dims[2] = 4;
+		dims[3] = image->bytesPerLine();
+		dims[4] = 4;
+		dims[5] = 1;
+		view->ndim = 3;
+		view->shape = dims;
+		view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? dims + 3 : NULL;
+		view->internal = dims;
+	}
+	self->fExports++;
+	return 0;
+}
+
+
+static void
+_releasebuffer(Bitmap_Proxy *self, Py_buffer *view)
+{
+	PyMem_Free(view->internal);
+	view->internal = NULL;
+	self->fExports--;
+}
+
+
+static PyBufferProcs _as_buffer = {
+	0,											/* bf_getreadbuffer */
+	0,											/* bf_getwritebuffer */
+	0,											/* bf_getsegcount */
+	0,											/* bf_getcharbuffer */
+	(getbufferproc)_getbuffer,					/* bf_getbuffer */
+	(releasebufferproc)_releasebuffer,			/* bf_releasebuffer */
+};
+
+
+SL_DEFINE_DEVICE_METHOD(get_size, {
+	return createVectorObject(QSize(device->width(), device->height()));
 })
 
 
-SL_DEFINE_DC_METHOD(set_size, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(set_size, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
 	QSize size;
 	
 	if (!PyArg_ParseTuple(args, "O&", convertSize, &size))
 		return NULL;
 	
-	painter->end();
+	endDCPainter(self);
 	*pixmap = pixmap->copy(QRect(QPoint(0,0), size));
-	painter->begin(pixmap);
 })
 
 
-SL_DEFINE_DC_METHOD(get_bits, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(get_bits, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
 	QByteArray buffer;
 	
 	QImage image = pixmap->toImage();
@@ -86,8 +181,10 @@ SL_DEFINE_DC_METHOD(get_bits, {
 })
 
 
-SL_DEFINE_DC_METHOD(set_bits, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(set_bits, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
 	QByteArray buffer;
 	
 	if (!PyArg_ParseTuple(args, "O&", convertBuffer, &buffer))
@@ -98,14 +195,15 @@ SL_DEFINE_DC_METHOD(set_bits, {
 		return NULL;
 	}
 	QImage image((const uchar *)buffer.data(), pixmap->width(), pixmap->height(), QImage::Format_ARGB32);
-	painter->end();
+	endDCPainter(self);
 	*pixmap = QPixmap::fromImage(image);
-	painter->begin(pixmap);
 })
 
 
-SL_DEFINE_DC_METHOD(blit, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(blit, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
 	PyObject *object, *sizeObj, *sourcePosObj, *sourceSizeObj;
 	QPoint pos, sourcePos;
 	QSize size;
@@ -139,19 +237,22 @@ SL_DEFINE_DC_METHOD(blit, {
 	if (!proxy)
 		return NULL;
 	
+	QPainter *painter = getDCPainter(proxy);
 	if (repeat) {
-		proxy->fPainter->fillRect(target, QBrush(*pixmap));
+		painter->fillRect(target, QBrush(*pixmap));
 	}
 	else {
-		proxy->fPainter->drawPixmap(target, *pixmap, source);
+		painter->drawPixmap(target, *pixmap, source);
 	}
 	
 	Py_DECREF(proxy);
 })
 
 
-SL_DEFINE_DC_METHOD(load, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(load, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
 	QByteArray bytes;
 	QBuffer buffer;
 	
@@ -165,33 +266,38 @@ SL_DEFINE_DC_METHOD(load, {
 		PyErr_Format(PyExc_RuntimeError,  "cannot load bitmap (%s)", (const char *)reader.errorString().toUtf8());
 		return NULL;
 	}
-	painter->end();
+	endDCPainter(self);
 	*pixmap = QPixmap::fromImage(image);
-	painter->begin(pixmap);
 })
 
 
-SL_DEFINE_DC_METHOD(save, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(save, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
 	QByteArray bytes;
 	QBuffer buffer(&bytes);
 	
-	painter->end();
+	endDCPainter(self);
 	pixmap->save(&buffer, "PNG");
-	painter->begin(pixmap);
 	
 	return createBufferObject(bytes);
 })
 
 
-SL_DEFINE_DC_METHOD(copy, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(copy, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
+	endDCPainter(self);
 	return createBitmapObject(*pixmap);
 })
 
 
-SL_DEFINE_DC_METHOD(resized, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(resized, {
+	QPixmap *pixmap = getPixmap(self);
+	if (!pixmap)
+		return NULL;
 	QSize size;
 	bool smooth;
 	
@@ -202,23 +308,100 @@ SL_DEFINE_DC_METHOD(resized, {
 })
 
 
-SL_DEFINE_DC_METHOD(colorized, {
-	QPixmap *pixmap = (QPixmap *)self->fDevice;
+SL_DEFINE_DEVICE_METHOD(colorized, {
 	QColor color;
 	
 	if (!PyArg_ParseTuple(args, "O&", convertColor, &color))
 		return NULL;
 	
-	QImage image = pixmap->toImage();
-	for (int y = 0; y < image.height(); y++) {
-		QRgb *rgb = (QRgb *)image.scanLine(y);
-		for (int x = 0; x < image.width(); x++) {
-			int hue = qGray(*rgb);
-			int alpha = qAlpha(*rgb);
-			*rgb++ = qRgba((color.red() * hue) >> 8, (color.green() * hue) >> 8, (color.blue() * hue) >> 8, alpha);
+	QImage image = getImage(self);
+	colorizePixels(image, color);
+	return createBitmapObject(image);
+})
+
+
+SL_DEFINE_DEVICE_METHOD(grayscaled, {
+	QImage image = getImage(self);
+	grayscalePixels(image);
+	return createBitmapObject(image);
+})
+
+
+SL_DEFINE_DEVICE_METHOD(premultiplied, {
+	QImage image = getImage(self);
+	premultiplyPixels(image);
+	return createBitmapObject(image);
+})
+
+
+SL_DEFINE_DEVICE_METHOD(adjusted, {
+	int brightness;
+	double contrast;
+	
+	if (!PyArg_ParseTuple(args, "id", &brightness, &contrast))
+		return NULL;
+	
+	QImage image = getImage(self);
+	adjustPixels(image, brightness, contrast);
+	return createBitmapObject(image);
+})
+
+
+SL_DEFINE_DEVICE_METHOD(swizzled, {
+	QString order;
+	
+	if (!PyArg_ParseTuple(args, "O&", convertString, &order))
+		return NULL;
+	
+	QImage image = getImage(self);
+	if (!swizzlePixels(image, order)) {
+		PyErr_SetString(PyExc_ValueError, "channel order must be made of four 'R', 'G', 'B' or 'A' letters");
+		return NULL;
+	}
+	return createBitmapObject(image);
+})
+
+
+SL_DEFINE_DEVICE_METHOD(blurred, {
+	int radius;
+	
+	if (!PyArg_ParseTuple(args, "i", &radius))
+		return NULL;
+	
+	QImage image = getImage(self);
+	blurPixels(image, radius);
+	return createBitmapObject(image);
+})
+
+
+SL_DEFINE_DEVICE_METHOD(lock, {
+	if (!isLocked(self)) {
+		QPixmap *pixmap = (QPixmap *)device;
+		endDCPainter(self);
+		QImage *image = new QImage(pixmap->toImage().convertToFormat(QImage::Format_ARGB32));
+		delete pixmap;
+		self->fDevice = image;
+	}
+})
+
+
+SL_DEFINE_DEVICE_METHOD(unlock, {
+	if (isLocked(self)) {
+		if (((Bitmap_Proxy *)self)->fExports > 0) {
+			PyErr_SetString(PyExc_BufferError, "cannot unlock bitmap while its pixels are being accessed");
+			return NULL;
 		}
+		QImage *image = (QImage *)device;
+		endDCPainter(self);
+		QPixmap *pixmap = new QPixmap(QPixmap::fromImage(*image));
+		delete image;
+		self->fDevice = pixmap;
 	}
-	return createBitmapObject(QPixmap::fromImage(image));
+})
+
+
+SL_DEFINE_DEVICE_METHOD(is_locked, {
+	return createBoolObject(isLocked(self));
 })
 
 
@@ -232,6 +415,14 @@ SL_METHOD(save)
 SL_METHOD(copy)
 SL_METHOD(resized)
 SL_METHOD(colorized)
+SL_METHOD(grayscaled)
+SL_METHOD(premultiplied)
+SL_METHOD(adjusted)
+SL_METHOD(swizzled)
+SL_METHOD(blurred)
+SL_METHOD(lock)
+SL_METHOD(unlock)
+SL_METHOD(is_locked)
 SL_END_METHODS()
 
 
@@ -240,7 +431,7 @@ PyTypeObject Bitmap_Type =
 	PyObject_HEAD_INIT(NULL)
 	0,											/* ob_size */
 	"slew._slew.Bitmap",						/* tp_name */
-	sizeof(DC_Proxy),							/* tp_basicsize */
+	sizeof(Bitmap_Proxy),						/* tp_basicsize */
 	0,											/* tp_itemsize */
 	(destructor)_dealloc,						/* tp_dealloc */
 	0,											/* tp_print */
@@ -256,8 +447,8 @@ PyTypeObject Bitmap_Type =
 	0,											/* tp_str */
 	0,											/* tp_getattro */
 	0,											/* tp_setattro */
-	0,											/* tp_as_buffer */
-	Py_TPFLAGS_DEFAULT,							/* tp_flags */
+	&_as_buffer,								/* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER,	/* tp_flags */
 	"Bitmap objects",							/* tp_doc */
 	0,											/* tp_traverse */
 	0,											/* tp_clear */
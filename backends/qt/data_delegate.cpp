@@ -21,16 +21,27 @@
 #include <QHeaderView>
 
 
+#define MAX_POOLED_EDITORS		4
+
+
 
 class Base_Editor
 {
 public:
 	Base_Editor(QWidget *parent, const QModelIndex& index)
 		: fView((QAbstractItemView *)parent->parent()), fIndex(index) {}
+	virtual ~Base_Editor() {}
+	
+	void setPoolKey(const QString& key) { fPoolKey = key; }
+	QString poolKey() { return fPoolKey; }
+	
+	virtual void reuse(const QModelIndex& index) { fIndex = index; }
+	virtual void release() { fIndex = QModelIndex(); }
 	
 protected:
 	QAbstractItemView			*fView;
 	QPersistentModelIndex		fIndex;
+	QString						fPoolKey;
 };
 
 
@@ -82,7 +93,7 @@ class LineEdit_Editor : public FormattedLineEdit, public Base_Editor
 	
 public:
 	LineEdit_Editor(QWidget *parent, const QModelIndex& index)
-		: FormattedLineEdit(parent), Base_Editor(parent, index), fCurrentCompletion(-1)
+		: FormattedLineEdit(parent), Base_Editor(parent, index), fCurrentCompletion(-1), fFormatted(false)
 	{
 		connect(this, SIGNAL(textModified(const QString&, int)), this, SLOT(handleTextModified(const QString&, int)));
 		connect(this, SIGNAL(iconClicked()), this, SLOT(handleStartEditingEvent()));
@@ -97,6 +108,32 @@ public:
 		return Completer::completion();
 	}
 	
+	void setFormat(int dataType, const QString& format)
+	{
+		if ((fFormatted) && (dataType == FormattedLineEdit::dataType()) && (format == FormattedLineEdit::format()))
+			return;
+		setDataType(dataType);
+		FormattedLineEdit::setFormat(format);
+		fFormatted = true;
+	}
+	
+	virtual void reuse(const QModelIndex& index)
+	{
+		Base_Editor::reuse(index);
+		fCurrentCompletion = -1;
+		blockSignals(true);
+		setText(QString());
+		setCursorPosition(0);
+		blockSignals(false);
+	}
+	
+	virtual void release()
+	{
+		Base_Editor::release();
+		setCompleter(NULL, 0, QColor(), QColor(), QColor(), QColor());
+		setIcon(QIcon());
+	}
+	
 	bool isModifyEvent(QEvent *event)
 	{
 		if (event->type() == QEvent::KeyPress) {
@@ -200,6 +237,7 @@ public slots:
 	
 private:
 	int			fCurrentCompletion;
+	bool		fFormatted;
 };
 
 
@@ -402,6 +440,12 @@ public:
 		fButton->setGeometry(QRect(size.width() - size.height(), 0, size.height(), size.height()));
 	}
 	
+	virtual void release()
+	{
+		Base_Editor::release();
+		fButton->setChecked(false);
+	}
+	
 public slots:
 	void handleStartEditingEvent(QEvent *event)
 	{
@@ -448,6 +492,23 @@ private:
 };
 
 
+static QString
+getEditorPoolKey(DataSpecifier *spec)
+{
+	if (spec->isCustom())
+		return QString();
+	else if (spec->isCheckBox())
+		return "checkbox";
+	else if (spec->isComboBox())
+		return getImpl(spec->fModel) ? QString() : "combobox";
+	else if (spec->isBrowser())
+		return "browser";
+	else if (spec->isSpinField())
+		return "spinbox";
+	return QString("lineedit:%1:%2").arg(spec->fDataType).arg(spec->fFormat);
+}
+
+
 static QRect
 getCheckRect(const QStyleOptionViewItem& o, DataSpecifier *spec, QSize *checkSize = NULL)
 {
@@ -748,6 +809,20 @@ ItemDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem& option,
 	if ((!spec) || (spec->isNone()))
 		return QItemDelegate::createEditor(parent, option, index);
 	
+	QString key = getEditorPoolKey(spec);
+	if (!key.isEmpty()) {
+		ItemDelegate *delegate = (ItemDelegate *)this;
+		while (delegate->fEditorsPool.contains(key)) {
+			editor = delegate->fEditorsPool.take(key);
+			if ((editor) && (editor->parent() == parent)) {
+				dynamic_cast<Base_Editor *>((QWidget *)editor)->reuse(index);
+				return editor;
+			}
+			if (editor)
+				editor->deleteLater();
+		}
+	}
+	
 	if (spec->isCustom()) {
 		editor = new Custom_Editor(parent, index, spec->fWidget);
 	}
@@ -767,10 +842,32 @@ ItemDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem& option,
 		editor = new LineEdit_Editor(parent, index);
 	}
 	
+	dynamic_cast<Base_Editor *>((QWidget *)editor)->setPoolKey(key);
+	
 	return editor;
 }
 
 
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+
+void
+ItemDelegate::destroyEditor(QWidget *editor, const QModelIndex& index) const
+{
+	ItemDelegate *delegate = (ItemDelegate *)this;
+	Base_Editor *base = dynamic_cast<Base_Editor *>(editor);
+	
+	if ((base) && (!base->poolKey().isEmpty()) && (delegate->fEditorsPool.count(base->poolKey()) < MAX_POOLED_EDITORS)) {
+		PyAutoLocker locker;
+		base->release();
+		delegate->fEditorsPool.insert(base->poolKey(), editor);
+		return;
+	}
+	QItemDelegate::destroyEditor(editor, index);
+}
+
+#endif
+
+
 bool
 ItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *abstractModel, const QStyleOptionViewItem& option, const QModelIndex& index)
 {
@@ -1116,16 +1213,22 @@ ItemDelegate::setEditorData(QWidget *editor, const QModelIndex& index) const
 	else if (spec->isText()) {
 		FormattedLineEdit *lineEdit = qobject_cast<FormattedLineEdit *>(editor);
 		if (lineEdit) {
+			LineEdit_Editor *pooled = qobject_cast<LineEdit_Editor *>(editor);
 			int pos = lineEdit->cursorPosition();
-			lineEdit->setDataType(spec->fDataType);
+			if (pooled)
+				pooled->setFormat(spec->fDataType, spec->fFormat);
+			else {
+				lineEdit->setDataType(spec->fDataType);
+				lineEdit->setFormat(spec->fFormat);
+			}
 			lineEdit->setAlignment(spec->fAlignment);
 			lineEdit->setMaxLength(spec->fLength ? spec->fLength : 32767);
-			lineEdit->setFormat(spec->fFormat);
 			lineEdit->setCapsOnly(spec->isCapsOnly());
 			lineEdit->setSelectedOnFocus(spec->isSelectedOnFocus());
 			lineEdit->setText(spec->fText);
 			lineEdit->setCursorPosition(pos);
-			lineEdit->internalValidator()->setRegExp(QRegExp(spec->fFilter));
+			if (lineEdit->internalValidator()->regExp().pattern() != spec->fFilter)
+				lineEdit->internalValidator()->setRegExp(QRegExp(spec->fFilter));
 			if ((!spec->fIcon.isNull()) && (spec->isClickableIcon()))
 				lineEdit->setIcon(spec->fIcon);
 			lineEdit->setCompleter((DataModel_Impl *)getImpl(spec->fCompleter.fModel), spec->fCompleter.fColumn, spec->fCompleter.fColor, spec->fCompleter.fBGColor, spec->fCompleter.fHIColor, spec->fCompleter.fHIBGColor);
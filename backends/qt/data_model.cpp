@@ -78,6 +78,8 @@ public:
 	int rowCount();
 	int columnCount();
 	bool hasChildren();
+	bool isRowCountKnown() { return fRowCount >= 0; }
+	void setRowCount(int count);
 	
 	void insertRows(int pos, int count);
 	void removeRows(int pos, int count);
@@ -247,20 +249,29 @@ Node::rowCount()
 			return 0;
 		}
 		
-		if (fChildren.size() < fRowCount) {
-			int num_columns = columnCount();
-			while (fChildren.size() < fRowCount) {
-				QList<Node *> *row = new QList<Node *>();
-				for (int i = 0; i < num_columns; i++)
-					row->append(NULL);
-				fChildren.append(row);
-			}
-		}
+		setRowCount(fRowCount);
 	}
 	return fRowCount;
 }
 
 
+void
+Node::setRowCount(int count)
+{
+	fRowCount = qMax(0, count);
+	
+	if (fChildren.size() < fRowCount) {
+		int num_columns = columnCount();
+		while (fChildren.size() < fRowCount) {
+			QList<Node *> *row = new QList<Node *>();
+			for (int i = 0; i < num_columns; i++)
+				row->append(NULL);
+			fChildren.append(row);
+		}
+	}
+}
+
+
 int
 Node::columnCount()
 {
@@ -659,7 +670,7 @@ Node::dataSpecifier()
 
 
 DataModel_Impl::DataModel_Impl()
-	: QAbstractItemModel(), fModel(NULL)
+	: QAbstractItemModel(), fModel(NULL), fFlushScheduled(false)
 {
 	fRoot = new Node(NULL, -1, -1, NULL);
 	connect(this, SIGNAL(modelReset()), this, SLOT(handleReset()));
@@ -669,6 +680,8 @@ DataModel_Impl::DataModel_Impl()
 DataModel_Impl::~DataModel_Impl()
 {
 	PyAutoLocker locker;
+	foreach (const Notification& notification, fNotifications)
+		Py_XDECREF(notification.fParent);
 	delete fRoot;
 	SL_QAPP()->unregisterObject(this);
 // 	qDebug() << "final count for" << fModel << "is" << sCounter.fCount[fModel];
@@ -696,6 +709,200 @@ DataModel_Impl::resetAll()
 }
 
 
+void
+DataModel_Impl::notify(int what, int index, int count, PyObject *parent)
+{
+	bool pending;
+	{
+		QMutexLocker locker(&fNotificationsLock);
+		pending = !fNotifications.isEmpty();
+	}
+	// keep ordering with changes posted by other threads
+	if (pending)
+		flushNotifications();
+	applyNotification(what, index, count, parent);
+}
+
+
+void
+DataModel_Impl::applyNotification(int what, int index, int count, PyObject *parent)
+{
+	switch (what) {
+	case SL_DATA_MODEL_NOTIFY_RESET:
+		{
+			resetAll();
+		}
+		break;
+		
+	case SL_DATA_MODEL_NOTIFY_ADDED_COLUMNS:
+		{
+			insertColumns(index, count, this->index(parent));
+		}
+		break;
+		
+	case SL_DATA_MODEL_NOTIFY_ADDED_ROWS:
+		{
+			insertRows(index, count, this->index(parent));
+		}
+		break;
+		
+	case SL_DATA_MODEL_NOTIFY_CHANGED_COLUMNS:
+		{
+			changeColumns(index, count, this->index(parent));
+		}
+		break;
+		
+	case SL_DATA_MODEL_NOTIFY_CHANGED_ROWS:
+		{
+			changeRows(index, count, this->index(parent));
+		}
+		break;
+		
+	case SL_DATA_MODEL_NOTIFY_REMOVED_COLUMNS:
+		{
+			removeColumns(index, count, this->index(parent));
+		}
+		break;
+		
+	case SL_DATA_MODEL_NOTIFY_REMOVED_ROWS:
+		{
+			removeRows(index, count, this->index(parent));
+		}
+		break;
+		
+	case SL_DATA_MODEL_NOTIFY_CHANGED_CELL:
+		{
+			changeCell(index, count, this->index(parent));
+		}
+		break;
+	}
+}
+
+
+bool
+DataModel_Impl::coalesceNotification(const Notification& notification, QList<PyObject *>& released)
+{
+	const int what = notification.fWhat;
+	
+	if (fNotifications.isEmpty())
+		return false;
+	
+	// a pending reset makes any other change redundant
+	if (fNotifications.first().fWhat == SL_DATA_MODEL_NOTIFY_RESET)
+		return true;
+	if (what == SL_DATA_MODEL_NOTIFY_RESET) {
+		foreach (const Notification& pending, fNotifications)
+			released.append(pending.fParent);
+		fNotifications.clear();
+		return false;
+	}
+	
+	// parents are compared by identity, since comparing by value would run Python code under the lock
+	for (int i = fNotifications.size() - 1; i >= 0; i--) {
+		Notification& pending = fNotifications[i];
+		bool changed = ((pending.fWhat == SL_DATA_MODEL_NOTIFY_CHANGED_ROWS) ||
+						(pending.fWhat == SL_DATA_MODEL_NOTIFY_CHANGED_COLUMNS) ||
+						(pending.fWhat == SL_DATA_MODEL_NOTIFY_CHANGED_CELL));
+		
+		if (!changed) {
+			// structural changes can only be merged with the last one, and only if contiguous
+			if ((i == fNotifications.size() - 1) && (pending.fWhat == what) && (pending.fParent == notification.fParent)) {
+				switch (what) {
+				case SL_DATA_MODEL_NOTIFY_ADDED_ROWS:
+				case SL_DATA_MODEL_NOTIFY_ADDED_COLUMNS:
+					if ((notification.fIndex >= pending.fIndex) && (notification.fIndex <= pending.fIndex + pending.fCount)) {
+						pending.fCount += notification.fCount;
+						return true;
+					}
+					break;
+				
+				case SL_DATA_MODEL_NOTIFY_REMOVED_ROWS:
+				case SL_DATA_MODEL_NOTIFY_REMOVED_COLUMNS:
+					if (notification.fIndex == pending.fIndex) {
+						pending.fCount += notification.fCount;
+						return true;
+					}
+					else if (notification.fIndex + notification.fCount == pending.fIndex) {
+						pending.fIndex = notification.fIndex;
+						pending.fCount += notification.fCount;
+						return true;
+					}
+					break;
+				}
+			}
+			return false;
+		}
+		
+		if (pending.fParent != notification.fParent)
+			continue;
+		
+		if ((what == SL_DATA_MODEL_NOTIFY_CHANGED_ROWS) || (what == SL_DATA_MODEL_NOTIFY_CHANGED_COLUMNS)) {
+			if (pending.fWhat == what) {
+				int end = qMax(pending.fIndex + pending.fCount, notification.fIndex + notification.fCount);
+				pending.fIndex = qMin(pending.fIndex, notification.fIndex);
+				pending.fCount = end - pending.fIndex;
+				return true;
+			}
+		}
+		else if (what == SL_DATA_MODEL_NOTIFY_CHANGED_CELL) {
+			if ((pending.fWhat == SL_DATA_MODEL_NOTIFY_CHANGED_CELL) && (pending.fIndex == notification.fIndex) && (pending.fCount == notification.fCount))
+				return true;
+			if ((pending.fWhat == SL_DATA_MODEL_NOTIFY_CHANGED_ROWS) && (notification.fIndex >= pending.fIndex) && (notification.fIndex < pending.fIndex + pending.fCount))
+				return true;
+		}
+	}
+	return false;
+}
+
+
+void
+DataModel_Impl::postNotify(int what, int index, int count, PyObject *parent)
+{
+	QList<PyObject *> released;
+	Notification notification;
+	
+	notification.fWhat = what;
+	notification.fIndex = index;
+	notification.fCount = count;
+	notification.fParent = (parent == Py_None) ? NULL : parent;
+	
+	{
+		QMutexLocker locker(&fNotificationsLock);
+		if (!coalesceNotification(notification, released)) {
+			Py_XINCREF(notification.fParent);
+			fNotifications.append(notification);
+		}
+		if (!fFlushScheduled) {
+			fFlushScheduled = true;
+			QMetaObject::invokeMethod(this, "flushNotifications", Qt::QueuedConnection);
+		}
+	}
+	
+	// dropping parents may run Python code, which must never happen under the lock
+	foreach (PyObject *object, released)
+		Py_XDECREF(object);
+}
+
+
+void
+DataModel_Impl::flushNotifications()
+{
+	QList<Notification> notifications;
+	{
+		QMutexLocker locker(&fNotificationsLock);
+		notifications = fNotifications;
+		fNotifications.clear();
+		fFlushScheduled = false;
+	}
+	
+	PyAutoLocker locker;
+	foreach (const Notification& notification, notifications) {
+		applyNotification(notification.fWhat, notification.fIndex, notification.fCount, notification.fParent ? notification.fParent : Py_None);
+		Py_XDECREF(notification.fParent);
+	}
+}
+
+
 void
 DataModel_Impl::resetHeader()
 {
@@ -738,6 +945,115 @@ DataModel_Impl::getDataIndex(const QModelIndex& index) const
 }
 
 
+bool
+DataModel_Impl::isRowCountKnown(const QModelIndex& parent) const
+{
+	Node *node;
+	if (parent.isValid())
+		node = (Node *)parent.internalPointer();
+	else
+		node = fRoot;
+	return node->isRowCountKnown();
+}
+
+
+void
+DataModel_Impl::prefetchRowCounts(const QModelIndexList& parents) const
+{
+	if (!Py_IsInitialized())
+		return;
+	
+	PyAutoLocker locker;
+	PyObject *model = fModel ? PyWeakref_GetObject(fModel) : Py_None;
+	QList<Node *> nodes;
+	
+	if (!PyObject_TypeCheck(model, (PyTypeObject *)PyDataModel_Type))
+		return;
+	
+	foreach (QModelIndex index, parents) {
+		if ((!index.isValid()) || (index.column() != 0))
+			continue;
+		Node *node = (Node *)index.internalPointer();
+		if (!node->isRowCountKnown())
+			nodes.append(node);
+	}
+	if (nodes.size() < 2)
+		return;
+	
+	PyObject *list = PyList_New(nodes.size());
+	for (int i = 0; i < nodes.size(); i++) {
+		PyObject *dataIndex = nodes[i]->dataIndex();
+		Py_INCREF(dataIndex);
+		PyList_SET_ITEM(list, i, dataIndex);
+	}
+	
+	Py_INCREF(model);
+	PyObject *result = PyObject_CallMethod(model, "child_counts", "O", list);
+	Py_DECREF(model);
+	Py_DECREF(list);
+	
+	if ((result) && (result != Py_None)) {
+		PyObject *sequence = PySequence_Fast(result, "expected sequence object");
+		if (sequence) {
+			if (PySequence_Fast_GET_SIZE(sequence) != nodes.size()) {
+				PyErr_SetString(PyExc_ValueError, "child_counts() must return one count per index");
+			}
+			else {
+				for (int i = 0; i < nodes.size(); i++) {
+					int count = PyInt_AsLong(PySequence_Fast_GET_ITEM(sequence, i));
+					if (PyErr_Occurred())
+						break;
+					nodes[i]->setRowCount(count);
+				}
+			}
+			Py_DECREF(sequence);
+		}
+	}
+	Py_XDECREF(result);
+	
+	if (PyErr_Occurred()) {
+		PyErr_Print();
+		PyErr_Clear();
+	}
+}
+
+
+PyObject *
+DataModel_Impl::getRowKeys(const QModelIndexList& indexes) const
+{
+	PyAutoLocker locker;
+	PyObject *model = fModel ? PyWeakref_GetObject(fModel) : Py_None;
+	
+	if (!PyObject_TypeCheck(model, (PyTypeObject *)PyDataModel_Type)) {
+		PyErr_SetString(PyExc_ValueError, "expected DataModel object");
+		return NULL;
+	}
+	
+	PyObject *list = PyList_New(indexes.size());
+	for (int i = 0; i < indexes.size(); i++) {
+		PyObject *dataIndex = getDataIndex(indexes.at(i));
+		Py_INCREF(dataIndex);
+		PyList_SET_ITEM(list, i, dataIndex);
+	}
+	
+	Py_INCREF(model);
+	PyObject *result = PyObject_CallMethod(model, "row_keys", "O", list);
+	Py_DECREF(model);
+	Py_DECREF(list);
+	if (!result)
+		return NULL;
+	
+	PyObject *keys = PySequence_Fast(result, "expected sequence object");
+	Py_DECREF(result);
+	if ((keys) && (PySequence_Fast_GET_SIZE(keys) != indexes.size())) {
+		Py_DECREF(keys);
+		PyErr_SetString(PyExc_ValueError, "row_keys() must return one key per index");
+		return NULL;
+	}
+	return keys;
+}
+
+
 void
 DataModel_Impl::invalidateDataSpecifiers()
 {
@@ -1506,55 +1822,10 @@ SL_DEFINE_METHOD(DataModel, notify, {
 	if (!PyArg_ParseTuple(args, "iiiO", &what, &index, &count, &parent))
 		return NULL;
 	
-	switch (what) {
-	case SL_DATA_MODEL_NOTIFY_RESET:
-		{
-			impl->resetAll();
-		}
-		break;
-		
-	case SL_DATA_MODEL_NOTIFY_ADDED_COLUMNS:
-		{
-			impl->insertColumns(index, count, impl->index(parent));
-		}
-		break;
-		
-	case SL_DATA_MODEL_NOTIFY_ADDED_ROWS:
-		{
-			impl->insertRows(index, count, impl->index(parent));
-		}
-		break;
-		
-	case SL_DATA_MODEL_NOTIFY_CHANGED_COLUMNS:
-		{
-			impl->changeColumns(index, count, impl->index(parent));
-		}
-		break;
-		
-	case SL_DATA_MODEL_NOTIFY_CHANGED_ROWS:
-		{
-			impl->changeRows(index, count, impl->index(parent));
-		}
-		break;
-		
-	case SL_DATA_MODEL_NOTIFY_REMOVED_COLUMNS:
-		{
-			impl->removeColumns(index, count, impl->index(parent));
-		}
-		break;
-		
-	case SL_DATA_MODEL_NOTIFY_REMOVED_ROWS:
-		{
-			impl->removeRows(index, count, impl->index(parent));
-		}
-		break;
-		
-	case SL_DATA_MODEL_NOTIFY_CHANGED_CELL:
-		{
-			impl->changeCell(index, count, impl->index(parent));
-		}
-		break;
-	}
+	if (QThread::currentThread() == impl->thread())
+		impl->notify(what, index, count, parent);
+	else
+		impl->postNotify(what, index, count, parent);
 })
 
 
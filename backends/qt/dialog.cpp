@@ -89,7 +89,8 @@ Dialog_Impl::resizeEvent(QResizeEvent *event)
 		EventRunner runner(this, "onResize");
 		if (runner.isValid()) {
 			runner.set("size", event->size());
-			runner.run();
+			if (!SL_QAPP()->coalescer()->post(this, runner))
+				runner.run();
 		}
 	}
 }
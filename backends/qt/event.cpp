@@ -0,0 +1,269 @@
+#include "slew.h"
+
+#include "objects.h"
+
+#include <QVariant>
+
+
+typedef struct Event_Proxy {
+	PyObject_HEAD
+	PyObject					*fDict;
+	EventFields					*fFields;
+} Event_Proxy;
+
+
+static PyObject *
+createFieldObject(const QVariant& value)
+{
+	switch ((int)value.type()) {
+	case QVariant::Bool:		return createBoolObject(value.toBool());
+	case QVariant::Int:			return PyInt_FromLong(value.toInt());
+	case QVariant::Double:		return PyFloat_FromDouble(value.toDouble());
+	case QVariant::String:		return createStringObject(value.toString());
+	case QVariant::Point:		return createVectorObject(value.toPoint());
+	case QVariant::PointF:		return createVectorObject(value.toPointF());
+	case QVariant::Size:		return createVectorObject(value.toSize());
+	case QVariant::SizeF:		return createVectorObject(value.toSizeF());
+	case QVariant::Color:		return createColorObject(value.value<QColor>());
+	case QVariant::Font:		return createFontObject(value.value<QFont>());
+	case QVariant::ByteArray:	return createBufferObject(value.toByteArray());
+	case QVariant::Date:		return createDateObject(value.toDate());
+	case QVariant::DateTime:	return createDateTimeObject(value.toDateTime());
+	case QVariant::Pixmap:		return createBitmapObject(value.value<QPixmap>());
+	case QVariant::Icon:		return createIconObject(value.value<QIcon>());
+	default:
+		break;
+	}
+	Py_RETURN_NONE;
+}
+
+
+static PyObject *
+getDict(Event_Proxy *self)
+{
+	if (!self->fDict)
+		self->fDict = PyDict_New();
+	return self->fDict;
+}
+
+
+static bool
+materialize(Event_Proxy *self)
+{
+	PyObject *dict = getDict(self);
+	if (!dict)
+		return false;
+	if (self->fFields) {
+		EventFields *fields = self->fFields;
+		self->fFields = NULL;
+		for (EventFields::const_iterator it = fields->constBegin(); it != fields->constEnd(); ++it) {
+			PyObject *value = createFieldObject(it.value());
+			if ((!value) || (PyDict_SetItemString(dict, it.key().constData(), value) < 0)) {
+				Py_XDECREF(value);
+				delete fields;
+				return false;
+			}
+			Py_DECREF(value);
+		}
+		delete fields;
+	}
+	return true;
+}
+
+
+static int
+Event_init(Event_Proxy *self, PyObject *args, PyObject *kwds)
+{
+	if (PyTuple_GET_SIZE(args) > 0) {
+		PyErr_SetString(PyExc_TypeError, "Event takes keyword arguments only");
+		return -1;
+	}
+	if (kwds) {
+		PyObject *dict = getDict(self);
+		if ((!dict) || (PyDict_Update(dict, kwds) < 0))
+			return -1;
+	}
+	return 0;
+}
+
+
+static int
+Event_traverse(Event_Proxy *self, visitproc visit, void *arg)
+{
+	Py_VISIT(self->fDict);
+	return 0;
+}
+
+
+static int
+Event_clear(Event_Proxy *self)
+{
+	Py_CLEAR(self->fDict);
+	return 0;
+}
+
+
+static void
+Event_dealloc(Event_Proxy *self)
+{
+	PyObject_GC_UnTrack(self);
+	Event_clear(self);
+	delete self->fFields;
+	self->ob_type->tp_free((PyObject*)self);
+}
+
+
+static PyObject *
+Event_getattro(Event_Proxy *self, PyObject *name)
+{
+	if ((self->fFields) && (PyString_Check(name))) {
+		EventFields::iterator it = self->fFields->find(QByteArray::fromRawData(PyString_AS_STRING(name), PyString_GET_SIZE(name)));
+		if (it != self->fFields->end()) {
+			PyObject *dict = getDict(self);
+			PyObject *value = createFieldObject(it.value());
+			if ((!dict) || (!value)) {
+				Py_XDECREF(value);
+				return NULL;
+			}
+			self->fFields->erase(it);
+			if (PyDict_SetItem(dict, name, value) < 0) {
+				Py_DECREF(value);
+				return NULL;
+			}
+			return value;
+		}
+	}
+	return PyObject_GenericGetAttr((PyObject *)self, name);
+}
+
+
+static int
+Event_setattro(Event_Proxy *self, PyObject *name, PyObject *value)
+{
+	if ((self->fFields) && (PyString_Check(name)))
+		self->fFields->remove(QByteArray::fromRawData(PyString_AS_STRING(name), PyString_GET_SIZE(name)));
+	return PyObject_GenericSetAttr((PyObject *)self, name, value);
+}
+
+
+static PyObject *
+Event_repr(Event_Proxy *self)
+{
+	if (!materialize(self))
+		return NULL;
+	return PyObject_Repr(self->fDict);
+}
+
+
+static PyObject *
+Event_str(Event_Proxy *self)
+{
+	if (!materialize(self))
+		return NULL;
+	return PyObject_Str(self->fDict);
+}
+
+
+static PyObject *
+Event_get_dict(Event_Proxy *self, void *closure)
+{
+	if (!materialize(self))
+		return NULL;
+	Py_INCREF(self->fDict);
+	return self->fDict;
+}
+
+
+static PyGetSetDef Event_getset[] = {
+	{	(char *)"__dict__", (getter)Event_get_dict, NULL, NULL, NULL },
+	{	NULL, NULL, NULL, NULL, NULL }
+};
+
+
+PyTypeObject Event_Type =
+{
+	PyObject_HEAD_INIT(NULL)
+	0,											/* ob_size */
+	"slew._slew.Event",							/* tp_name */
+	sizeof(Event_Proxy),						/* tp_basicsize */
+	0,											/* tp_itemsize */
+	(destructor)Event_dealloc,					/* tp_dealloc */
+	0,											/* tp_print */
+	0,											/* tp_getattr */
+	0,											/* tp_setattr */
+	0,											/* tp_compare */
+	(reprfunc)Event_repr,						/* tp_repr */
+	0,											/* tp_as_number */
+	0,											/* tp_as_sequence */
+	0,											/* tp_as_mapping */
+	0,											/* tp_hash */
+	0,											/* tp_call */
+	(reprfunc)Event_str,						/* tp_str */
+	(getattrofunc)Event_getattro,				/* tp_getattro */
+	(setattrofunc)Event_setattro,				/* tp_setattro */
+	0,											/* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,	/* tp_flags */
+	"Event objects",							/* tp_doc */
+	(traverseproc)Event_traverse,				/* tp_traverse */
+	(inquiry)Event_clear,						/* tp_clear */
+	0,											/* tp_richcompare */
+	0,											/* tp_weaklistoffset */
+	0,											/* tp_iter */
+	0,											/* tp_iternext */
+	0,											/* tp_methods */
+	0,											/* tp_members */
+	Event_getset,								/* tp_getset */
+	0,											/* tp_base */
+	0,											/* tp_dict */
+	0,											/* tp_descr_get */
+	0,											/* tp_descr_set */
+	offsetof(Event_Proxy, fDict),				/* tp_dictoffset */
+	(initproc)Event_init,						/* tp_init */
+	0,											/* tp_alloc */
+	PyType_GenericNew,							/* tp_new */
+};
+
+
+PyObject *
+createEventObject(PyObject *params, const EventFields& fields)
+{
+	Event_Proxy *self = (Event_Proxy *)Event_Type.tp_alloc(&Event_Type, 0);
+	if (!self)
+		return NULL;
+	self->fDict = PyDict_Copy(params);
+	if (!self->fDict) {
+		Py_DECREF(self);
+		return NULL;
+	}
+	if (!fields.isEmpty())
+		self->fFields = new EventFields(fields);
+	return (PyObject *)self;
+}
+
+
+void
+inheritEventConstants(PyObject *cls)
+{
+	PyObject *key, *value;
+	Py_ssize_t pos = 0;
+	
+	if ((!cls) || (!PyType_Check(cls)))
+		return;
+	
+	while (PyDict_Next(((PyTypeObject *)cls)->tp_dict, &pos, &key, &value)) {
+		if ((PyString_Check(key)) && (PyInt_Check(value)))
+			PyDict_SetItem(Event_Type.tp_dict, key, value);
+	}
+	PyType_Modified(&Event_Type);
+}
+
+
+bool
+Event_type_setup(PyObject *module)
+{
+	if (PyType_Ready(&Event_Type) < 0)
+		return false;
+	Py_INCREF(&Event_Type);
+	PyModule_AddObject(module, "Event", (PyObject *)&Event_Type);
+	return true;
+}
@@ -107,7 +107,8 @@ public:
 			EventRunner runner(fParent, "onResize");
 			if (runner.isValid()) {
 				runner.set("size", size);
-				runner.run();
+				if (!SL_QAPP()->coalescer()->post(fParent, runner))
+					runner.run();
 			}
 		}
 	}
@@ -143,6 +144,7 @@ FoldPanel_Impl::FoldPanel_Impl()
 	setAnimated(true);
 	
 	fShortcut = new QShortcut(QKeySequence("Ctrl+Alt+E"), this, NULL, NULL, Qt::WidgetWithChildrenShortcut);
+	registerShortcut(fShortcut, fShortcut->key());
 	connect(fShortcut, SIGNAL(activated()), this, SLOT(toggleExpand()));
 	connect(fExpander, SIGNAL(clicked()), this, SLOT(toggleExpand()));
 	connect(fContent, SIGNAL(layoutChanged()), this, SLOT(setupLayout()), Qt::QueuedConnection);
@@ -52,7 +52,7 @@ public:
 	void setDuration(int duration) { fDuration = duration; setAnimated(fTimeLine != NULL); }
 	int duration() { return fDuration; }
 	
-	void setShortcut(const QString& key) { fShortcut->setKey(key); }
+	void setShortcut(const QString& key) { fShortcut->setKey(key); registerShortcut(fShortcut, fShortcut->key()); }
 	QString shortcut() { return fShortcut->key().toString(); }
 	
 	void updatePalette();
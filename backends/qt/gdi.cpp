@@ -5,9 +5,117 @@
 
 
 #include <QFontMetricsF>
+#include <QPicture>
+#include <QSet>
 
 
 
+struct DC_State
+{
+	QPen					fPen;
+	QBrush					fBrush;
+	QFont					fFont;
+	QTransform				fTransform;
+	QPainter::RenderHints	fHints;
+	qreal					fOpacity;
+	bool					fClipping;
+	QPainterPath			fClipPath;
+};
+
+
+static QSet<DC_Proxy *> sOpenPainters;
+
+
+QPainter *
+getDCPainter(DC_Proxy *self)
+{
+	// bitmaps and pictures only get a painter while something is being drawn on them
+	if ((!self->fPainter) && (self->fDevice)) {
+		QPainter *painter = new QPainter;
+		if (self->fDevice->devType() == QInternal::Picture) {
+			QPicture *pict = (QPicture *)self->fDevice;
+			QPicture contents;
+			if (!pict->isNull())
+				contents.setData(pict->data(), pict->size());
+			painter->begin(pict);
+			if (!contents.isNull())
+				painter->drawPicture(0, 0, contents);
+		}
+		else {
+			painter->begin(self->fDevice);
+			painter->setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::NonCosmeticDefaultPen);
+			painter->translate(0.5, 0.5);
+		}
+		
+		DC_State *state = self->fState;
+		if (state) {
+			painter->setPen(state->fPen);
+			painter->setBrush(state->fBrush);
+			painter->setFont(state->fFont);
+			painter->setTransform(state->fTransform);
+			painter->setRenderHints(painter->renderHints(), false);
+			painter->setRenderHints(state->fHints);
+			painter->setOpacity(state->fOpacity);
+			if (state->fClipping)
+				painter->setClipPath(state->fClipPath);
+		}
+		self->fPainter = painter;
+		
+		if (sOpenPainters.isEmpty())
+			scheduleCloseDCPainters();
+		sOpenPainters.insert(self);
+	}
+	return self->fPainter;
+}
+
+
+void
+endDCPainter(DC_Proxy *self)
+{
+	// only painters opened by getDCPainter are ended, keeping their state for the next one
+	if (!sOpenPainters.remove(self))
+		return;
+	
+	QPainter *painter = self->fPainter;
+	DC_State *state = self->fState;
+	if (!state)
+		self->fState = state = new DC_State;
+	state->fPen = painter->pen();
+	state->fBrush = painter->brush();
+	state->fFont = painter->font();
+	state->fTransform = painter->transform();
+	state->fHints = painter->renderHints();
+	state->fOpacity = painter->opacity();
+	state->fClipping = painter->hasClipping();
+	state->fClipPath = state->fClipping ? painter->clipPath() : QPainterPath();
+	
+	painter->end();
+	delete painter;
+	self->fPainter = NULL;
+}
+
+
+void
+closeDCPainters()
+{
+	PyAutoLocker locker;
+	
+	foreach (DC_Proxy *self, sOpenPainters) {
+		endDCPainter(self);
+	}
+}
+
+
+void
+freeDCResources(DC_Proxy *self)
+{
+	sOpenPainters.remove(self);
+	delete self->fState;
+	self->fState = NULL;
+	freeBitmapResources(self->fPainter, self->fDevice);
+}
+
+
 SL_DEFINE_DC_METHOD(get_color, {
 	return createColorObject(painter->pen().color());
 })
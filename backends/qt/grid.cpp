@@ -29,7 +29,7 @@ private:
 
 
 Grid_Impl::Grid_Impl()
-	: QTableView(), WidgetInterface(), fHeaders(Qt::Horizontal)
+	: QTableView(), WidgetInterface(), fHeaders(Qt::Horizontal), fUniformRows(false), fRowHeight(0), fRowHeightMeasured(false)
 {
 	setHorizontalScrollMode(ScrollPerPixel);
 	setVerticalScrollMode(ScrollPerPixel);
@@ -333,6 +333,7 @@ Grid_Impl::setModel(QAbstractItemModel *model)
 		disconnect(oldModel, SIGNAL(configureHeader(const QPoint&, Qt::TextElideMode)), this, SLOT(handleConfigureHeader(const QPoint&, Qt::TextElideMode)));
 		disconnect(oldModel, SIGNAL(sorted(int, Qt::SortOrder)), this, SLOT(handleSortIndicatorChanged(int, Qt::SortOrder)));
 		disconnect(oldModel, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(resizeColumns()));
+		disconnect(oldModel, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(updateRowHeight()));
 		disconnect(oldModel, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(handleRowsColsRemoved(QModelIndex, int, int)));
 		disconnect(oldModel, SIGNAL(columnsRemoved(QModelIndex, int, int)), this, SLOT(handleRowsColsRemoved(QModelIndex, int, int)));
 		disconnect(oldModel, SIGNAL(modelReset()), this, SLOT(resetColumns()));
@@ -342,6 +343,7 @@ Grid_Impl::setModel(QAbstractItemModel *model)
 		connect(model, SIGNAL(configureHeader(const QPoint&, Qt::TextElideMode)), this, SLOT(handleConfigureHeader(const QPoint&, Qt::TextElideMode)));
 		connect(model, SIGNAL(sorted(int, Qt::SortOrder)), this, SLOT(handleSortIndicatorChanged(int, Qt::SortOrder)));
 		connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(resizeColumns()));
+		connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(updateRowHeight()));
 		connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(handleRowsColsRemoved(QModelIndex, int, int)), Qt::QueuedConnection);
 		connect(model, SIGNAL(columnsRemoved(QModelIndex, int, int)), this, SLOT(handleRowsColsRemoved(QModelIndex, int, int)));
 		connect(model, SIGNAL(modelReset()), this, SLOT(resetColumns()), Qt::QueuedConnection);
@@ -352,6 +354,53 @@ Grid_Impl::setModel(QAbstractItemModel *model)
 	QTableView::setModel(model);
 	delete m;
 	connect(selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)), this, SLOT(handleSelectionChanged(const QItemSelection&, const QItemSelection&)));
+	
+	fRowHeightMeasured = false;
+	updateRowHeight();
+}
+
+
+void
+Grid_Impl::setUniformRowHeights(bool enabled)
+{
+	if (enabled == fUniformRows)
+		return;
+	fUniformRows = enabled;
+	fRowHeightMeasured = false;
+	if (enabled)
+		verticalHeader()->QT_SET_SECTION_RESIZE_MODE(QHeaderView::Fixed);
+	updateRowHeight();
+}
+
+
+void
+Grid_Impl::setDefaultRowHeight(int height)
+{
+	fRowHeight = qMax(0, height);
+	fRowHeightMeasured = false;
+	updateRowHeight();
+}
+
+
+void
+Grid_Impl::updateRowHeight()
+{
+	int height = fRowHeight;
+	
+	if ((height <= 0) && (fUniformRows)) {
+		// Measure first row only once, so that scrolling never asks the delegate for per-row size hints
+		if (fRowHeightMeasured)
+			return;
+		QAbstractItemModel *model = this->model();
+		if ((!model) || (model->rowCount() == 0) || (model->columnCount() == 0))
+			return;
+		fRowHeightMeasured = true;
+		height = sizeHintForRow(0);
+	}
+	if (height <= 0)
+		height = QFontMetrics(font()).height() + 5;
+	
+	verticalHeader()->setDefaultSectionSize(height);
 }
 
 
@@ -573,6 +622,8 @@ Grid_Impl::reset()
 	Grid_Delegate *delegate = qobject_cast<Grid_Delegate *>(itemDelegate());
 	if (delegate)
 		delegate->invalidate();
+	fRowHeightMeasured = false;
+	updateRowHeight();
 }
 
 
@@ -871,7 +922,7 @@ SL_DEFINE_METHOD(Grid, set_default_row_height, {
 	if (!PyArg_ParseTuple(args, "i", &height))
 		return NULL;
 	
-	impl->verticalHeader()->setDefaultSectionSize(height > 0 ? height : QFontMetrics(impl->font()).height() + 5);
+	impl->setDefaultRowHeight(height);
 })
 
 
@@ -925,6 +976,8 @@ SL_DEFINE_METHOD(Grid, get_style, {
 		style |= SL_GRID_STYLE_DELAYED_EDIT;
 	if (impl->hasAutoScroll())
 		style |= SL_GRID_STYLE_AUTO_SCROLL;
+	if (impl->uniformRowHeights())
+		style |= SL_GRID_STYLE_UNIFORM_ROWS;
 	
 	return PyInt_FromLong(style);
 })
@@ -942,7 +995,8 @@ SL_DEFINE_METHOD(Grid, set_style, {
 	impl->setHeaderEnabled(Qt::Horizontal, style & SL_GRID_STYLE_HEADER ? true : false);
 	impl->verticalHeader()->setVisible(style & SL_GRID_STYLE_VERTICAL_HEADER ? true : false);
 	impl->setHeaderEnabled(Qt::Vertical, style & SL_GRID_STYLE_VERTICAL_HEADER ? true : false);
-	impl->verticalHeader()->QT_SET_SECTION_RESIZE_MODE(style & SL_GRID_STYLE_AUTO_ROWS ? QHeaderView::ResizeToContents : QHeaderView::Fixed);
+	impl->verticalHeader()->QT_SET_SECTION_RESIZE_MODE(((style & SL_GRID_STYLE_AUTO_ROWS) && (!(style & SL_GRID_STYLE_UNIFORM_ROWS))) ? QHeaderView::ResizeToContents : QHeaderView::Fixed);
+	impl->setUniformRowHeights(style & SL_GRID_STYLE_UNIFORM_ROWS ? true : false);
 	impl->horizontalHeader()->QT_SET_SECTIONS_CLICKABLE(style & SL_GRID_STYLE_SORTABLE ? true : false);
 	impl->setAlternatingRowColors(style & SL_GRID_STYLE_ALT_ROWS ? true : false);
 	impl->setSortingEnabled(style & SL_GRID_STYLE_SORTABLE ? true : false);
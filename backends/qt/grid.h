@@ -28,6 +28,10 @@ public:
 	void setHeaderEnabled(Qt::Orientation type, bool enabled) { if (enabled) { fHeaders |= type; } else { fHeaders &= ~type; } }
 	bool isHeaderEnabled(Qt::Orientation type) { return fHeaders & type; }
 	
+	void setUniformRowHeights(bool enabled);
+	bool uniformRowHeights() { return fUniformRows; }
+	void setDefaultRowHeight(int height);
+	
 	virtual void setModel(QAbstractItemModel *model);
 	
 	virtual bool isFocusOutEvent(QEvent *event);
@@ -53,6 +57,7 @@ public slots:
 	virtual void dataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
 	virtual void dataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight) { dataChanged(topLeft, bottomRight, QVector<int>()); }
 	void resizeColumns();
+	void updateRowHeight();
 	
 	QStyleOptionViewItem initOptionView() { return viewOptions(); }
 	void prepareDrag() { setDirtyRegion(viewport()->rect()); startAutoScroll(); }
@@ -68,6 +73,9 @@ protected:
 
 private:
 	Qt::Orientations		fHeaders;
+	bool					fUniformRows;
+	int						fRowHeight;
+	bool					fRowHeightMeasured;
 	QPersistentModelIndex	fEditIndex;
 };
 
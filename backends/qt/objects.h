@@ -13,6 +13,8 @@
 #include <QTextDocument>
 #include <QAbstractTextDocumentLayout>
 #include <QCache>
+#include <QMultiHash>
+#include <QPointer>
 
 
 
@@ -133,19 +135,40 @@ public:
 	DataSpecifier *getDataSpecifier(const QModelIndex& index) const;
 	PyObject *getDataIndex(const QModelIndex& index) const;
 	
+	bool isRowCountKnown(const QModelIndex& parent) const;
+	void prefetchRowCounts(const QModelIndexList& parents) const;
+	PyObject *getRowKeys(const QModelIndexList& indexes) const;
+	
 	void invalidateDataSpecifiers();
 	
+	void notify(int what, int index, int count, PyObject *parent);
+	void postNotify(int what, int index, int count, PyObject *parent);
+	
 signals:
 	void sorted(int column, Qt::SortOrder order);
 	void configureHeader(const QPoint& headerPos, Qt::TextElideMode elideMode) const;
 
 private slots:
 	void handleReset();
+	void flushNotifications();
 	
 private:
+	struct Notification {
+		int									fWhat;
+		int									fIndex;
+		int									fCount;
+		PyObject							*fParent;
+	};
+	
+	void applyNotification(int what, int index, int count, PyObject *parent);
+	bool coalesceNotification(const Notification& notification, QList<PyObject *>& released);
+	
 	Node									*fRoot;
 	QList<DataSpecifier *>					fHeaderData;
 	PyObject								*fModel;
+	QMutex									fNotificationsLock;
+	QList<Notification>						fNotifications;
+	bool									fFlushScheduled;
 };
 
 
@@ -161,6 +184,9 @@ public:
 	virtual void drawDisplay(QPainter *painter, const QStyleOptionViewItem& option, const QRect& rect, const QString& text) const;
 	
 	virtual QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+	virtual void destroyEditor(QWidget *editor, const QModelIndex& index) const;
+#endif
 	virtual bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem& option, const QModelIndex& index);
 	virtual bool eventFilter(QObject *object, QEvent *event);
 	virtual void updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem& option, const QModelIndex& index) const;
@@ -189,6 +215,7 @@ protected:
 	QPixmap								fInvalidPattern;
 	QModelIndex							fCurrentIndex;
 	QCache<QModelIndex, QTextDocument>	fTextDocumentsCache;
+	QMultiHash<QString, QPointer<QWidget> >	fEditorsPool;
 };
 
 
@@ -234,9 +261,14 @@ private:
 extern PyObject *PyDC_Type;
 extern PyObject *PyPrintDC_Type;
 extern PyTypeObject DC_Type;
+extern PyTypeObject Bitmap_Type;
+extern PyTypeObject Picture_Type;
 
 extern PyObject *PyPaper_Type;
 extern PyObject *PyEvent_Type;
+extern PyObject *PyEventHandler_Type;
+extern PyTypeObject Event_Type;
+extern PyTypeObject Task_Type;
 extern PyObject *PyDataIndex_Type;
 extern PyObject *PyDataSpecifier_Type;
 extern PyObject *PyDataModel_Type;
@@ -249,6 +281,28 @@ bool SceneItemDC_type_setup(PyObject *module);
 bool Bitmap_type_setup(PyObject *module);
 bool Picture_type_setup(PyObject *module);
 bool DataModel_type_setup(PyObject *module);
+bool Event_type_setup(PyObject *module);
+bool Task_type_setup(PyObject *module);
+
+PyObject *createEventObject(PyObject *params, const EventFields& fields);
+void inheritEventConstants(PyObject *cls);
+
+PyObject *runInBackground(PyObject *func, PyObject *args, PyObject *onDone, PyObject *onError, PyObject *onProgress);
+PyObject *getCurrentTask();
+void setBackgroundConcurrency(int count);
+int backgroundConcurrency();
+PyObject *decodeInBackground(const QByteArray& data, const QSize& size, PyObject *callback);
+void setDecodeConcurrency(int count);
+int decodeConcurrency();
+void shutdownBackgroundTasks();
+
+void grayscalePixels(QImage& image, bool simd = true);
+void premultiplyPixels(QImage& image, bool simd = true);
+void colorizePixels(QImage& image, const QColor& color, bool simd = true);
+void adjustPixels(QImage& image, int brightness, double contrast, bool simd = true);
+bool swizzlePixels(QImage& image, const QString& order, bool simd = true);
+void blurPixels(QImage& image, int radius, bool simd = true);
+PyObject *benchmarkPixelKernels(const QSize& size, int iterations);
 
 
 
@@ -20,6 +20,7 @@ _new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 		self->fDevice = NULL;
 		self->fPainter = NULL;
 		self->fBaseTransform = NULL;
+		self->fState = NULL;
 	}
 	return (PyObject *)self;
 }
@@ -32,7 +33,7 @@ _init(DC_Proxy *self, PyObject *args, PyObject *kwds)
 	if (!PyArg_ParseTuple(args, "|O&", convertSize, &size))
 		return -1;
 	
-	delete self->fPainter;
+	endDCPainter(self);
 	delete self->fDevice;
 	
 	QPicture *pict = new QPicture();
@@ -40,8 +41,7 @@ _init(DC_Proxy *self, PyObject *args, PyObject *kwds)
 		pict->setBoundingRect(QRect(QPoint(0,0), size));
 	
 	self->fDevice = pict;
-	self->fPainter = new QPainter(pict);
-// 	self->fPainter->setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::NonCosmeticDefaultPen);
+	self->fPainter = NULL;
 	
 	return 0;
 }
@@ -50,12 +50,12 @@ _init(DC_Proxy *self, PyObject *args, PyObject *kwds)
 static void
 _dealloc(DC_Proxy *self)
 {
-	freeBitmapResources(self->fPainter, self->fDevice);
+	freeDCResources(self);
 	self->ob_type->tp_free((PyObject*)self);
 }
 
 
-SL_DEFINE_DC_METHOD(get_size, {
+SL_DEFINE_DEVICE_METHOD(get_size, {
 	QPicture *pict = (QPicture *)self->fDevice;
 	QRect rect = pict->boundingRect();
 	rect.setTopLeft(QPoint(0, 0));
@@ -66,7 +66,7 @@ SL_DEFINE_DC_METHOD(get_size, {
 })
 
 
-SL_DEFINE_DC_METHOD(set_size, {
+SL_DEFINE_DEVICE_METHOD(set_size, {
 	QPicture *pict = (QPicture *)self->fDevice;
 	QSize size;
 	
@@ -77,7 +77,7 @@ SL_DEFINE_DC_METHOD(set_size, {
 })
 
 
-SL_DEFINE_DC_METHOD(blit, {
+SL_DEFINE_DEVICE_METHOD(blit, {
 	QPicture *pict = (QPicture *)self->fDevice;
 	PyObject *object, *sizeObj, *sourcePosObj, *sourceSizeObj;
 	QPoint pos, sourcePos;
@@ -113,24 +113,24 @@ SL_DEFINE_DC_METHOD(blit, {
 		return NULL;
 	}
 	else {
-		QPaintDevice *dev = proxy->fPainter->device();
+		endDCPainter(self);
+		QPainter *painter = getDCPainter(proxy);
+		QPaintDevice *dev = painter->device();
 		double xScale, yScale;
 		xScale = ((double)target.width() / (double)source.width()) * ((double)qt_defaultDpiX() / dev->logicalDpiX());
 		yScale = ((double)target.height() / (double)source.height()) * ((double)qt_defaultDpiY() / dev->logicalDpiY());
-		painter->end();
-		proxy->fPainter->save();
-		proxy->fPainter->translate(target.topLeft());
-		proxy->fPainter->scale(xScale, yScale);
-		pict->play(proxy->fPainter);
-		proxy->fPainter->restore();
-		painter->begin(pict);
+		painter->save();
+		painter->translate(target.topLeft());
+		painter->scale(xScale, yScale);
+		pict->play(painter);
+		painter->restore();
 	}
 	
 	Py_DECREF(proxy);
 })
 
 
-SL_DEFINE_DC_METHOD(load, {
+SL_DEFINE_DEVICE_METHOD(load, {
 	QPicture *pict = (QPicture *)self->fDevice;
 	QByteArray bytes;
 	QBuffer buffer;
@@ -142,9 +142,9 @@ SL_DEFINE_DC_METHOD(load, {
 	buffer.setData(bytes);
 	buffer.open(QIODevice::ReadOnly);
 	if (newPict.load(&buffer)) {
-		painter->end();
-		painter->begin(pict);
-		painter->drawPicture(0, 0, newPict);
+		endDCPainter(self);
+		QPainter painter(pict);
+		painter.drawPicture(0, 0, newPict);
 	}
 	else {
 		QSvgRenderer renderer(bytes);
@@ -152,33 +152,33 @@ SL_DEFINE_DC_METHOD(load, {
 			PyErr_Format(PyExc_RuntimeError,  "cannot load picture");
 			return NULL;
 		}
-		painter->end();
+		endDCPainter(self);
 		*pict = QPicture();
 		QRect rect = renderer.viewBox();
 		rect.setTopLeft(QPoint(0, 0));
 		pict->setBoundingRect(rect);
-		painter->begin(pict);
-		renderer.render(painter);
+		QPainter painter(pict);
+		renderer.render(&painter);
 	}
 })
 
 
-SL_DEFINE_DC_METHOD(save, {
+SL_DEFINE_DEVICE_METHOD(save, {
 	QPicture *pict = (QPicture *)self->fDevice;
 	QByteArray bytes;
 	QBuffer buffer(&bytes);
 	buffer.open(QIODevice::WriteOnly);
 	
-	painter->end();
+	endDCPainter(self);
 	pict->save(&buffer);
-	painter->begin(pict);
 	
 	return createBufferObject(bytes);
 })
 
 
-SL_DEFINE_DC_METHOD(copy, {
+SL_DEFINE_DEVICE_METHOD(copy, {
 	QPicture *pict = (QPicture *)self->fDevice;
+	endDCPainter(self);
 	return createPictureObject(*pict);
 })
 
@@ -0,0 +1,555 @@
+#include "slew.h"
+
+#include "objects.h"
+
+#include <QElapsedTimer>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define SL_PIXELS_SIMD		"avx2"
+#elif (defined(__SSE2__)) || (defined(_M_X64)) || ((defined(_M_IX86_FP)) && (_M_IX86_FP >= 2))
+	#include <emmintrin.h>
+	#define SL_PIXELS_SIMD		"sse2"
+#endif
+
+
+// kernels work on ARGB32 pixels in 32 bit words; vector code keeps one pixel per 32 bit lane so that it
+// uses the same arithmetic as the scalar code. AVX2 is used when the extension is built with it enabled.
+
+#if defined(__AVX2__)
+
+typedef __m256i Vec;
+enum { kVecPixels = 8 };
+
+static inline Vec vload(const quint32 *p) { return _mm256_loadu_si256((const __m256i *)p); }
+static inline void vstore(quint32 *p, Vec v) { _mm256_storeu_si256((__m256i *)p, v); }
+static inline Vec vset(int value) { return _mm256_set1_epi32(value); }
+static inline Vec vand(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+static inline Vec vor(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+static inline Vec vadd(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+static inline Vec vsub(Vec a, Vec b) { return _mm256_sub_epi32(a, b); }
+static inline Vec vshr(Vec a, int n) { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline Vec vshl(Vec a, int n) { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline Vec vsar(Vec a, int n) { return _mm256_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline Vec vmul(Vec a, Vec b) { return _mm256_mullo_epi16(a, b); }
+static inline Vec vmuls(Vec a, Vec b) { return _mm256_madd_epi16(a, b); }
+static inline Vec vmulhi(Vec a, Vec b) { return _mm256_mulhi_epu16(a, b); }
+
+static inline Vec
+vclamp(Vec a)
+{
+	Vec zero = _mm256_setzero_si256();
+	a = _mm256_packs_epi32(a, a);
+	a = _mm256_packus_epi16(a, a);
+	a = _mm256_unpacklo_epi8(a, zero);
+	return _mm256_unpacklo_epi16(a, zero);
+}
+
+#elif defined(SL_PIXELS_SIMD)
+
+typedef __m128i Vec;
+enum { kVecPixels = 4 };
+
+static inline Vec vload(const quint32 *p) { return _mm_loadu_si128((const __m128i *)p); }
+static inline void vstore(quint32 *p, Vec v) { _mm_storeu_si128((__m128i *)p, v); }
+static inline Vec vset(int value) { return _mm_set1_epi32(value); }
+static inline Vec vand(Vec a, Vec b) { return _mm_and_si128(a, b); }
+static inline Vec vor(Vec a, Vec b) { return _mm_or_si128(a, b); }
+static inline Vec vadd(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+static inline Vec vsub(Vec a, Vec b) { return _mm_sub_epi32(a, b); }
+static inline Vec vshr(Vec a, int n) { return _mm_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline Vec vshl(Vec a, int n) { return _mm_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline Vec vsar(Vec a, int n) { return _mm_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline Vec vmul(Vec a, Vec b) { return _mm_mullo_epi16(a, b); }
+static inline Vec vmuls(Vec a, Vec b) { return _mm_madd_epi16(a, b); }
+static inline Vec vmulhi(Vec a, Vec b) { return _mm_mulhi_epu16(a, b); }
+
+static inline Vec
+vclamp(Vec a)
+{
+	Vec zero = _mm_setzero_si128();
+	a = _mm_packs_epi32(a, a);
+	a = _mm_packus_epi16(a, a);
+	a = _mm_unpacklo_epi8(a, zero);
+	return _mm_unpacklo_epi16(a, zero);
+}
+
+#endif
+
+// vmul() needs operands and product to fit in 16 bits, vmuls() takes a signed 16 bit value and a
+// positive 16 bit factor, vmulhi() returns (a * b) >> 16 of 16 bit operands.
+
+#ifdef SL_PIXELS_SIMD
+
+static inline Vec
+channel(Vec p, int shift)
+{
+	return vand(vshr(p, shift), vset(0xff));
+}
+
+
+static inline Vec
+grayOf(Vec p)
+{
+	return vshr(vadd(vadd(vmul(channel(p, 16), vset(11)), vmul(channel(p, 8), vset(16))), vmul(channel(p, 0), vset(5))), 5);
+}
+
+#endif
+
+
+static inline quint32
+channel(quint32 p, int shift)
+{
+	return (p >> shift) & 0xff;
+}
+
+
+static inline quint32
+grayOf(quint32 p)
+{
+	// same weights as qGray()
+	return ((channel(p, 16) * 11) + (channel(p, 8) * 16) + (channel(p, 0) * 5)) >> 5;
+}
+
+
+
+struct Grayscale
+{
+	quint32 operator()(quint32 p) const
+	{
+		quint32 gray = grayOf(p);
+		return (p & 0xff000000) | (gray << 16) | (gray << 8) | gray;
+	}
+
+#ifdef SL_PIXELS_SIMD
+	Vec operator()(Vec p) const
+	{
+		Vec gray = grayOf(p);
+		return vor(vand(p, vset((int)0xff000000)), vor(vshl(gray, 16), vor(vshl(gray, 8), gray)));
+	}
+#endif
+};
+
+
+struct Premultiply
+{
+	static quint32 scale(quint32 c, quint32 a)
+	{
+		quint32 t = (c * a) + 128;
+		return (t + (t >> 8)) >> 8;
+	}
+	
+	quint32 operator()(quint32 p) const
+	{
+		quint32 a = p >> 24;
+		return (p & 0xff000000) | (scale(channel(p, 16), a) << 16) | (scale(channel(p, 8), a) << 8) | scale(channel(p, 0), a);
+	}
+
+#ifdef SL_PIXELS_SIMD
+	static Vec scale(Vec c, Vec a)
+	{
+		Vec t = vadd(vmul(c, a), vset(128));
+		return vshr(vadd(t, vshr(t, 8)), 8);
+	}
+	
+	Vec operator()(Vec p) const
+	{
+		Vec a = vshr(p, 24);
+		return vor(vand(p, vset((int)0xff000000)), vor(vshl(scale(channel(p, 16), a), 16), vor(vshl(scale(channel(p, 8), a), 8), scale(channel(p, 0), a))));
+	}
+#endif
+};
+
+
+struct Colorize
+{
+	Colorize(const QColor& color) : fRed(color.red()), fGreen(color.green()), fBlue(color.blue()) {}
+	
+	quint32 operator()(quint32 p) const
+	{
+		quint32 gray = grayOf(p);
+		return (p & 0xff000000) | (((fRed * gray) >> 8) << 16) | (((fGreen * gray) >> 8) << 8) | ((fBlue * gray) >> 8);
+	}
+
+#ifdef SL_PIXELS_SIMD
+	Vec operator()(Vec p) const
+	{
+		Vec gray = grayOf(p);
+		Vec red = vshr(vmul(gray, vset(fRed)), 8);
+		Vec green = vshr(vmul(gray, vset(fGreen)), 8);
+		Vec blue = vshr(vmul(gray, vset(fBlue)), 8);
+		return vor(vand(p, vset((int)0xff000000)), vor(vshl(red, 16), vor(vshl(green, 8), blue)));
+	}
+#endif
+
+	quint32		fRed;
+	quint32		fGreen;
+	quint32		fBlue;
+};
+
+
+struct Adjust
+{
+	Adjust(int brightness, double contrast) : fOffset(128 + qBound(-255, brightness, 255)), fFactor(qBound(0, qRound(contrast * 256), 32767)) {}
+	
+	quint32 level(quint32 c) const
+	{
+		return qBound(0, ((((int)c - 128) * fFactor) >> 8) + fOffset, 255);
+	}
+	
+	quint32 operator()(quint32 p) const
+	{
+		return (p & 0xff000000) | (level(channel(p, 16)) << 16) | (level(channel(p, 8)) << 8) | level(channel(p, 0));
+	}
+
+#ifdef SL_PIXELS_SIMD
+	Vec level(Vec c) const
+	{
+		return vclamp(vadd(vsar(vmuls(vsub(c, vset(128)), vset(fFactor)), 8), vset(fOffset)));
+	}
+	
+	Vec operator()(Vec p) const
+	{
+		return vor(vand(p, vset((int)0xff000000)), vor(vshl(level(channel(p, 16)), 16), vor(vshl(level(channel(p, 8)), 8), level(channel(p, 0)))));
+	}
+#endif
+
+	int			fOffset;
+	int			fFactor;
+};
+
+
+struct Swizzle
+{
+	quint32 operator()(quint32 p) const
+	{
+		return (channel(p, fSource[0]) << 16) | (channel(p, fSource[1]) << 8) | channel(p, fSource[2]) | (channel(p, fSource[3]) << 24);
+	}
+
+#ifdef SL_PIXELS_SIMD
+	Vec operator()(Vec p) const
+	{
+		return vor(vor(vshl(channel(p, fSource[0]), 16), vshl(channel(p, fSource[1]), 8)), vor(channel(p, fSource[2]), vshl(channel(p, fSource[3]), 24)));
+	}
+#endif
+
+	int			fSource[4];
+};
+
+
+
+static void
+ensureFormat(QImage& image)
+{
+	if (image.format() != QImage::Format_ARGB32)
+		image = image.convertToFormat(QImage::Format_ARGB32);
+}
+
+
+template <typename Kernel>
+static void
+applyKernel(QImage& image, const Kernel& kernel, bool simd)
+{
+	ensureFormat(image);
+	
+	int width = image.width();
+	for (int y = 0; y < image.height(); y++) {
+		quint32 *line = (quint32 *)image.scanLine(y);
+		int x = 0;
+#ifdef SL_PIXELS_SIMD
+		if (simd) {
+			for (; x + kVecPixels <= width; x += kVecPixels)
+				vstore(line + x, kernel(vload(line + x)));
+		}
+#else
+		(void)simd;
+#endif
+		for (; x < width; x++)
+			line[x] = kernel(line[x]);
+	}
+}
+
+
+void
+grayscalePixels(QImage& image, bool simd)
+{
+	applyKernel(image, Grayscale(), simd);
+}
+
+
+void
+premultiplyPixels(QImage& image, bool simd)
+{
+	applyKernel(image, Premultiply(), simd);
+	
+	// tag the result, or converting it to a pixmap would premultiply it again
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 9, 0))
+	image.reinterpretAsFormat(QImage::Format_ARGB32_Premultiplied);
+#else
+	image = QImage(image.constBits(), image.width(), image.height(), image.bytesPerLine(), QImage::Format_ARGB32_Premultiplied).copy();
+#endif
+}
+
+
+void
+colorizePixels(QImage& image, const QColor& color, bool simd)
+{
+	applyKernel(image, Colorize(color), simd);
+}
+
+
+void
+adjustPixels(QImage& image, int brightness, double contrast, bool simd)
+{
+	applyKernel(image, Adjust(brightness, contrast), simd);
+}
+
+
+bool
+swizzlePixels(QImage& image, const QString& order, bool simd)
+{
+	Swizzle kernel;
+	
+	if (order.length() != 4)
+		return false;
+	for (int i = 0; i < 4; i++) {
+		switch (order.at(i).toUpper().toLatin1()) {
+		case 'R':	kernel.fSource[i] = 16; break;
+		case 'G':	kernel.fSource[i] = 8; break;
+		case 'B':	kernel.fSource[i] = 0; break;
+		case 'A':	kernel.fSource[i] = 24; break;
+		default:
+			return false;
+		}
+	}
+	applyKernel(image, kernel, simd);
+	return true;
+}
+
+
+
+static inline quint32
+packSum(const quint32 *sum, quint32 recip)
+{
+	return (((sum[3] * recip) >> 16) << 24) | (((sum[2] * recip) >> 16) << 16) | (((sum[1] * recip) >> 16) << 8) | ((sum[0] * recip) >> 16);
+}
+
+
+static void
+blurLine(const quint32 *src, int srcStride, quint32 *dst, int dstStride, int count, int radius, quint32 recip)
+{
+	quint32 sum[4] = { 0, 0, 0, 0 };
+	
+	// sliding window over the line, clamping reads at both ends
+	for (int i = -radius; i <= radius; i++) {
+		quint32 p = src[qBound(0, i, count - 1) * srcStride];
+		for (int c = 0; c < 4; c++)
+			sum[c] += channel(p, c * 8);
+	}
+	for (int i = 0; i < count; i++) {
+		dst[i * dstStride] = packSum(sum, recip);
+		quint32 in = src[qMin(i + radius + 1, count - 1) * srcStride];
+		quint32 out = src[qMax(i - radius, 0) * srcStride];
+		for (int c = 0; c < 4; c++)
+			sum[c] += channel(in, c * 8) - channel(out, c * 8);
+	}
+}
+
+
+#ifdef SL_PIXELS_SIMD
+
+static void
+blurColumns(const quint32 *src, int srcStride, quint32 *dst, int dstStride, int count, int radius, quint32 recip)
+{
+	Vec sum[4] = { vset(0), vset(0), vset(0), vset(0) };
+	Vec factor = vset(recip);
+	
+	for (int i = -radius; i <= radius; i++) {
+		Vec p = vload(src + (qBound(0, i, count - 1) * srcStride));
+		for (int c = 0; c < 4; c++)
+			sum[c] = vadd(sum[c], channel(p, c * 8));
+	}
+	for (int i = 0; i < count; i++) {
+		vstore(dst + (i * dstStride), vor(vor(vshl(vmulhi(sum[3], factor), 24), vshl(vmulhi(sum[2], factor), 16)), vor(vshl(vmulhi(sum[1], factor), 8), vmulhi(sum[0], factor))));
+		Vec in = vload(src + (qMin(i + radius + 1, count - 1) * srcStride));
+		Vec out = vload(src + (qMax(i - radius, 0) * srcStride));
+		for (int c = 0; c < 4; c++)
+			sum[c] = vsub(vadd(sum[c], channel(in, c * 8)), channel(out, c * 8));
+	}
+}
+
+#endif
+
+
+void
+blurPixels(QImage& image, int radius, bool simd)
+{
+	ensureFormat(image);
+	
+	// window sums must fit in 16 bits for the vector division
+	radius = qBound(0, radius, 127);
+	int width = image.width();
+	int height = image.height();
+	if ((radius == 0) || (width == 0) || (height == 0))
+		return;
+	
+	int span = (radius * 2) + 1;
+	quint32 recip = (65536 + span - 1) / span;
+	QVector<quint32> temp(width * height);
+	quint32 *tmp = temp.data();
+	
+	for (int y = 0; y < height; y++)
+		blurLine((const quint32 *)image.constScanLine(y), 1, tmp + (y * width), 1, width, radius, recip);
+	
+	quint32 *bits = (quint32 *)image.bits();
+	int stride = image.bytesPerLine() / 4;
+	int x = 0;
+#ifdef SL_PIXELS_SIMD
+	if (simd) {
+		for (; x + kVecPixels <= width; x += kVecPixels)
+			blurColumns(tmp + x, width, bits + x, stride, height, radius, recip);
+	}
+#else
+	(void)simd;
+#endif
+	for (; x < width; x++)
+		blurLine(tmp + x, width, bits + x, stride, height, radius, recip);
+}
+
+
+
+static QImage
+createSampleImage(const QSize& size)
+{
+	QImage image(size, QImage::Format_ARGB32);
+	
+	for (int y = 0; y < image.height(); y++) {
+		QRgb *line = (QRgb *)image.scanLine(y);
+		for (int x = 0; x < image.width(); x++)
+			line[x] = qRgba((x * 7) & 0xff, (y * 5) & 0xff, (x ^ y) & 0xff, 128 + ((x + y) & 0x7f));
+	}
+	return image;
+}
+
+
+template <typename Operation>
+static PyObject *
+measure(const QImage& sample, int iterations, Operation operation)
+{
+	qint64 total = 0;
+	
+	for (int i = 0; i < iterations; i++) {
+		QImage image = sample.copy();
+		QElapsedTimer timer;
+		timer.start();
+		operation(image);
+		total += timer.nsecsElapsed();
+	}
+	return PyFloat_FromDouble((double)total / (1000000.0 * qMax(1, iterations)));
+}
+
+
+struct RunKernel
+{
+	enum { kGrayscale, kPremultiply, kColorize, kAdjust, kSwizzle, kBlur };
+	
+	RunKernel(int kernel, bool simd) : fKernel(kernel), fSIMD(simd) {}
+	
+	void operator()(QImage& image) const
+	{
+		switch (fKernel) {
+		case kGrayscale:	grayscalePixels(image, fSIMD); break;
+		case kPremultiply:	premultiplyPixels(image, fSIMD); break;
+		case kColorize:		colorizePixels(image, QColor(255, 128, 0), fSIMD); break;
+		case kAdjust:		adjustPixels(image, 20, 1.25, fSIMD); break;
+		case kSwizzle:		swizzlePixels(image, "BGRA", fSIMD); break;
+		case kBlur:			blurPixels(image, 4, fSIMD); break;
+		}
+	}
+	
+	int			fKernel;
+	bool		fSIMD;
+};
+
+
+struct RunQt
+{
+	RunQt(int kernel) : fKernel(kernel) {}
+	
+	void operator()(QImage& image) const
+	{
+		switch (fKernel) {
+		case RunKernel::kPremultiply:
+			image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+			break;
+		case RunKernel::kColorize:
+			{
+				QPainter painter(&image);
+				painter.setCompositionMode(QPainter::CompositionMode_Multiply);
+				painter.fillRect(image.rect(), QColor(255, 128, 0));
+			}
+			break;
+		case RunKernel::kSwizzle:
+			image = image.rgbSwapped();
+			break;
+		}
+	}
+	
+	int			fKernel;
+};
+
+
+static bool
+compareKernel(const QImage& sample, int kernel)
+{
+	QImage simd = sample.copy();
+	QImage scalar = sample.copy();
+	
+	RunKernel(kernel, true)(simd);
+	RunKernel(kernel, false)(scalar);
+	return simd == scalar;
+}
+
+
+PyObject *
+benchmarkPixelKernels(const QSize& size, int iterations)
+{
+	static const char *names[] = { "grayscale", "premultiply", "colorize", "adjust", "swizzle", "blur" };
+	QImage sample = createSampleImage(size);
+	PyObject *dict = PyDict_New();
+	if (!dict)
+		return NULL;
+
+#ifdef SL_PIXELS_SIMD
+	PyObject *value = PyString_FromString(SL_PIXELS_SIMD);
+#else
+	PyObject *value = PyString_FromString("scalar");
+#endif
+	PyDict_SetItemString(dict, "instruction_set", value);
+	Py_XDECREF(value);
+	
+	for (int kernel = 0; kernel < 6; kernel++) {
+		PyObject *entry = PyDict_New();
+		if (!entry) {
+			Py_DECREF(dict);
+			return NULL;
+		}
+		value = measure(sample, iterations, RunKernel(kernel, true));
+		PyDict_SetItemString(entry, "simd_ms", value);
+		Py_XDECREF(value);
+		value = measure(sample, iterations, RunKernel(kernel, false));
+		PyDict_SetItemString(entry, "scalar_ms", value);
+		Py_XDECREF(value);
+		value = createBoolObject(compareKernel(sample, kernel));
+		PyDict_SetItemString(entry, "match", value);
+		Py_XDECREF(value);
+		if ((kernel == RunKernel::kPremultiply) || (kernel == RunKernel::kColorize) || (kernel == RunKernel::kSwizzle)) {
+			value = measure(sample, iterations, RunQt(kernel));
+			PyDict_SetItemString(entry, "qt_ms", value);
+			Py_XDECREF(value);
+		}
+		PyDict_SetItemString(dict, names[kernel], entry);
+		Py_DECREF(entry);
+	}
+	return dict;
+}
@@ -12,14 +12,20 @@ extern PyTypeObject Abstract_Type;
 bool Abstract_type_setup(PyObject *module);
 
 
+struct DC_State;
+
 typedef struct DC_Proxy {
 	PyObject_HEAD
 	QPaintDevice	*fDevice;
 	QPainter		*fPainter;
 	QTransform		*fBaseTransform;
+	DC_State		*fState;
 } DC_Proxy;
 
 
+class HandlerCache;
+
+
 
 #define SL_START_METHODS(name)						\
 namespace name {									\
@@ -45,7 +51,7 @@ name *impl = (name *)self->fImpl;					\
 (void)impl;
 
 #define SL_DC()										\
-QPainter *painter = self->fPainter;					\
+QPainter *painter = getDCPainter(self);				\
 QPaintDevice *device = self->fDevice;				\
 QTransform *baseTransform = self->fBaseTransform;	\
 (void)painter;										\
@@ -77,6 +83,15 @@ static PyObject * _##name (							\
 	Py_RETURN_NONE;									\
 }
 
+#define SL_DEFINE_DEVICE_METHOD(name, ...)			\
+static PyObject * _##name (							\
+	DC_Proxy *self, PyObject *args) {				\
+	QPaintDevice *device = self->fDevice;			\
+	(void)device;									\
+	__VA_ARGS__										\
+	Py_RETURN_NONE;									\
+}
+
 #define SL_DEFINE_MODULE_METHOD(name, ...)			\
 namespace slew { static PyObject * _##name (		\
 	PyObject *self, PyObject *args, PyObject *kwds) { \
@@ -94,6 +109,7 @@ typedef struct name##_Proxy							\
 	PyObject_HEAD									\
 	Widget_Impl				*fImpl;					\
 	PyObject				*fWidget;				\
+	HandlerCache			*fHandlers;				\
 } name##_Proxy;
 
 
@@ -107,6 +123,7 @@ typedef struct name##_Proxy							\
 	PyObject_HEAD									\
 	name##_Impl				*fImpl;					\
 	PyObject				*fWidget;				\
+	HandlerCache			*fHandlers;				\
 } name##_Proxy;
 
 
@@ -257,6 +274,7 @@ name##_dealloc ( name##_Proxy *self)													\
 	QMutexLocker locker(SL_QAPP()->getLock());											\
 	SL_QAPP()->deallocProxy((Abstract_Proxy *)self);									\
 	Py_DECREF(self->fWidget);															\
+	delete self->fHandlers;																\
 	self->ob_type->tp_free((PyObject*)self);											\
 }																						\
 static int																				\
@@ -83,7 +83,7 @@ Radio_Impl::setGroup(const QString& group)
 	
 	fGroup = group;
 	if (window)
-		groupName = QString("[%1]/%2").arg(window->objectName()).arg(group);
+		groupName = QString("[%1]/%2").arg((quintptr)window, 0, 16).arg(group);
 	else
 		groupName = QString("[]/%1").arg(group);
 	
@@ -119,7 +119,7 @@ Radio_Impl::handleToggled(bool toggled)
 
 
 SL_DEFINE_METHOD(Radio, get_group, {
-	return createStringObject(impl->group());
+	return createInternedStringObject(impl->group());
 })
 
 
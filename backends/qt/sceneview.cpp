@@ -178,6 +178,9 @@ SceneItem_Impl::sceneEvent(QEvent *event)
 				runner.set("buttons", (int)e->buttons());
 				runner.set("modifiers", getKeyModifiers(e->modifiers()));
 				
+				if (e->type() != QEvent::GraphicsSceneMouseMove)
+					SL_QAPP()->coalescer()->deliver(this);
+				
 				switch (e->type()) {
 				case QEvent::GraphicsSceneMousePress:
 					{
@@ -209,6 +212,10 @@ SceneItem_Impl::sceneEvent(QEvent *event)
 				default:
 					break;
 				}
+				if (e->type() == QEvent::GraphicsSceneMouseMove) {
+					if (SL_QAPP()->coalescer()->post(this, runner))
+						break;
+				}
 				if (!runner.run())
 					return true;
 			}
@@ -247,6 +254,13 @@ SceneItem_Impl::sceneEvent(QEvent *event)
 				default:
 					break;
 				}
+				if (e->type() == QEvent::GraphicsSceneHoverMove) {
+					if (SL_QAPP()->coalescer()->post(this, runner))
+						break;
+				}
+				else {
+					SL_QAPP()->coalescer()->deliver(this);
+				}
 				if (!runner.run())
 					return true;
 			}
@@ -265,6 +279,8 @@ SceneItem_Impl::sceneEvent(QEvent *event)
 				runner.set("buttons", (int)QApplication::mouseButtons());
 				runner.set("modifiers", getKeyModifiers(e->modifiers()));
 				runner.set("delta", e->delta() / 100);
+				if (SL_QAPP()->coalescer()->post(this, runner))
+					break;
 				if (!runner.run())
 					return true;
 			}
@@ -1099,7 +1115,8 @@ SceneView_Impl::resizeEvent(QResizeEvent *event)
 		EventRunner runner(this, "onResize");
 		if (runner.isValid()) {
 			runner.set("size", event->size());
-			runner.run();
+			if (!SL_QAPP()->coalescer()->post(this, runner))
+				runner.run();
 		}
 	}
 	QGraphicsView::resizeEvent(event);
@@ -64,6 +64,7 @@
 #include <QThread>
 #include <QThreadPool>
 #include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QRunnable>
 #include <QSemaphore>
 #include <QPointer>
@@ -76,6 +77,8 @@
 #include <QLabel>
 #include <QCheckBox>
 #include <QShortcut>
+#include <QMenu>
+#include <QAction>
 #include <QPaintEvent>
 #include <QMouseEvent>
 #include <QFileInfo>
@@ -108,6 +111,10 @@
 #include <QSettings>
 #include <QBitmap>
 #include <QFontDatabase>
+#include <QFontMetricsF>
+#include <QCache>
+#include <QBuffer>
+#include <QImageReader>
 #include <QPrintDialog>
 #include <QDialogButtonBox>
 #include <QEventLoop>
@@ -118,13 +125,14 @@
 
 class ResourceReader;
 class InfoBalloon;
-class TimedCall;
 class Shortcut;
 
 static PyObject *sApplication = NULL;
 static bool sIsRunning = false;
 static QEvent::Type sExceptionEvent;
 static QEvent::Type sFreeBitmapResourcesEvent;
+static QEvent::Type sCallQueueEvent;
+static QEvent::Type sCloseDCPaintersEvent;
 static int sArgc;
 static char **sArgv;
 static QLocale sLocale;
@@ -138,12 +146,18 @@ static ResourceReader *sResourceReader = NULL;
 static PyObject *sVectorType;
 static PyObject *sColorType;
 static PyObject *sFontType;
+static Py_ssize_t sVectorSlots[2] = { -1, -1 };
+static Py_ssize_t sColorSlots[4] = { -1, -1, -1, -1 };
+static Py_ssize_t sFontSlots[5] = { -1, -1, -1, -1, -1 };
 static PyObject *sBitmapType;
 static PyObject *sPictureType;
 static PyObject *sIconType;
 static PyObject *sSerializeData = NULL;
 static PyObject *sUnserializeData = NULL;
-static QKeyEvent sShortcutTestEvent(QEvent::None, 0, Qt::NoModifier);
+static QMultiHash<int, QPointer<QObject> > sShortcuts;
+static uint sProxyDataID = 0;
+static uint sInterfaceDataID = 0;
+static int sHierarchyGeneration = 0;
 
 PyObject *PyDC_Type;
 PyObject *PyPrintDC_Type;
@@ -152,92 +166,202 @@ PyObject *PyDataIndex_Type;
 PyObject *PyDataSpecifier_Type;
 PyObject *PyDataModel_Type;
 PyObject *PyEvent_Type = NULL;
+PyObject *PyEventHandler_Type = NULL;
 
 static int encodeButtons(int buttons);
 static int decodeButton(int button);
 
 
 
-class TimedCall : public QObject
+class ProxyData : public QObjectUserData
 {
-	Q_OBJECT
+public:
+	ProxyData(Abstract_Proxy *proxy) : fProxy(proxy) {}
 	
+	Abstract_Proxy		*fProxy;
+};
+
+
+
+class CallQueue
+{
 public:
-	TimedCall(QObject *parent, PyObject *func, PyObject *args)
-		: QObject(), fFunc(func), fArgs(args), fID(0)
+	CallQueue() : fFirst(NULL), fLast(NULL), fBudget(10), fExecuted(0), fDrains(0), fOverruns(0) {}
+	
+	// may be called from any thread, with the GIL held
+	void post(PyObject *func, PyObject *args)
 	{
-		Py_XINCREF(func);
-		Py_XINCREF(args);
+		Node *node = new Node(func, args);
+		Node *head;
+		
+		do {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+			head = fHead.load();
+#else
+			head = fHead;
+#endif
+			node->fNext = head;
+		} while (!fHead.testAndSetRelease(head, node));
+		
+		int depth = fDepth.fetchAndAddRelaxed(1) + 1;
+		int peak;
+		do {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+			peak = fPeak.load();
+#else
+			peak = fPeak;
+#endif
+		} while ((depth > peak) && (!fPeak.testAndSetRelaxed(peak, depth)));
+		
+		schedule();
 	}
 	
-	~TimedCall()
+	// called by the main thread once per event loop iteration
+	void drain()
 	{
-		if (Py_IsInitialized()) {
-			PyAutoLocker locker;
-			
-			Py_XDECREF(fFunc);
-			Py_XDECREF(fArgs);
+		fScheduled.fetchAndStoreOrdered(0);
+		
+		Node *node = fHead.fetchAndStoreAcquire(NULL);
+		Node *first = NULL, *last = node;
+		while (node) {
+			Node *next = node->fNext;
+			node->fNext = first;
+			first = node;
+			node = next;
 		}
-	}
-
-	void execute()
-	{
-		if (Py_IsInitialized()) {
-			// QApplication::sendPostedEvents(0, QEvent::DeferredDelete);
-
-			PyAutoLocker locker;
+		if (first) {
+			if (fLast)
+				fLast->fNext = first;
+			else
+				fFirst = first;
+			fLast = last;
+		}
+		
+		if ((!fFirst) || (!Py_IsInitialized()))
+			return;
+		
+		PyAutoLocker locker;
+		QElapsedTimer timer;
+		timer.start();
+		fDrains++;
+		
+		while (fFirst) {
+			node = fFirst;
+			fFirst = node->fNext;
+			if (!fFirst)
+				fLast = NULL;
+			fDepth.deref();
 			
-			QObject *widget = parent();
-			if (widget) {
-				EventRunner runner(widget, "onTimer");
-				if (runner.isValid()) {
-					if (fArgs)
-						runner.set("args", fArgs, false);
-					else
-						runner.set("args", PyTuple_New(0));
-					runner.run();
-				}
-			}
-			else {
-				PyObject *result = PyObject_CallObject(fFunc, fArgs);
-				if (!result) {
-					PyErr_Print();
-					PyErr_Clear();
-				}
-				else {
-					Py_DECREF(result);
-				}
+			// callbacks may run a nested event loop, which must keep draining the rest
+			if (fFirst)
+				schedule();
+			node->call();
+			delete node;
+			fExecuted++;
+			
+			if ((fFirst) && (fBudget > 0) && (timer.elapsed() >= fBudget)) {
+				fOverruns++;
+				break;
 			}
 		}
+		if (fFirst)
+			schedule();
 	}
 	
-public slots:
-	void executeAndDelete()
-	{
-		stop();
-		execute();
-		deleteLater();
-	}
+	void setBudget(int msecs) { fBudget = msecs; }
+	int budget() const { return fBudget; }
 	
-	void start(int delay) {
-
-		fID = startTimer(delay);
-	}
-
-	void stop()
+	PyObject *getStats(bool reset)
 	{
-		if (fID) {
-			killTimer(fID);
-			fID = 0;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+		int depth = fDepth.load();
+		int peak = fPeak.load();
+#else
+		int depth = fDepth;
+		int peak = fPeak;
+#endif
+		PyObject *dict = PyDict_New();
+		if (!dict)
+			return NULL;
+		
+		PyObject *value;
+		
+		value = PyInt_FromLong(depth);
+		PyDict_SetItemString(dict, "depth", value);
+		Py_XDECREF(value);
+		value = PyInt_FromLong(peak);
+		PyDict_SetItemString(dict, "peak", value);
+		Py_XDECREF(value);
+		value = PyInt_FromLong(fExecuted);
+		PyDict_SetItemString(dict, "executed", value);
+		Py_XDECREF(value);
+		value = PyInt_FromLong(fDrains);
+		PyDict_SetItemString(dict, "drains", value);
+		Py_XDECREF(value);
+		value = PyInt_FromLong(fOverruns);
+		PyDict_SetItemString(dict, "overruns", value);
+		Py_XDECREF(value);
+		
+		if (reset) {
+			fPeak.fetchAndStoreRelaxed(depth);
+			fExecuted = 0;
+			fDrains = 0;
+			fOverruns = 0;
 		}
+		return dict;
 	}
 	
 private:
-	PyObject			*fFunc;
-	PyObject			*fArgs;
-	int					fID;
+	struct Node {
+		Node(PyObject *func, PyObject *args) : fNext(NULL), fFunc(func), fArgs(args)
+		{
+			Py_INCREF(func);
+			Py_XINCREF(args);
+		}
+		
+		~Node()
+		{
+			Py_DECREF(fFunc);
+			Py_XDECREF(fArgs);
+		}
+		
+		void call()
+		{
+			PyObject *result = PyObject_CallObject(fFunc, fArgs);
+			if (!result) {
+				PyErr_Print();
+				PyErr_Clear();
+			}
+			else {
+				Py_DECREF(result);
+			}
+		}
+		
+		Node				*fNext;
+		PyObject			*fFunc;
+		PyObject			*fArgs;
+	};
+	
+	void schedule()
+	{
+		if (fScheduled.testAndSetOrdered(0, 1))
+			QCoreApplication::postEvent(QCoreApplication::instance(), new QEvent(sCallQueueEvent));
+	}
+	
+	QAtomicPointer<Node>	fHead;
+	QAtomicInt				fScheduled;
+	QAtomicInt				fDepth;
+	QAtomicInt				fPeak;
+	Node					*fFirst;
+	Node					*fLast;
+	int						fBudget;
+	int						fExecuted;
+	int						fDrains;
+	int						fOverruns;
 };
 
+static CallQueue sCallQueue;
+
 
 
 class ExceptionDialog : public QDialog
@@ -400,9 +524,11 @@ public:
 		setContext(context);
 		connect(this, SIGNAL(activated()), this, SLOT(handleActivated()));
 		Py_INCREF(callback);
+		registerShortcut(this, key);
 	}
 	
 	~Shortcut() {
+		unregisterShortcut(this);
 		if (Py_IsInitialized()) {
 			PyAutoLocker locker;
 			Py_DECREF(fCallback);
@@ -809,13 +935,43 @@ class ZipReader : public ResourceReader
 {
 public:
 	ZipReader(const QString& path)
-		: ResourceReader(path + ".sla")
+		: ResourceReader(path + ".sla"), fArchive(fSource), fMap(NULL), fMapSize(0)
 	{
 		fFile = unzOpen(fSource.toUtf8());
+		if (!fFile)
+			return;
+		
+		char name[1024];
+		unz_file_info info;
+		Entry entry;
+		int result = unzGoToFirstFile(fFile);
+		while (result == UNZ_OK) {
+			if ((unzGetCurrentFileInfo(fFile, &info, name, sizeof(name), NULL, 0, NULL, 0) == UNZ_OK) && (unzGetFilePos(fFile, &entry.fPos) == UNZ_OK)) {
+				entry.fMethod = info.compression_method;
+				entry.fFlags = info.flag;
+				entry.fSize = info.uncompressed_size;
+				entry.fCompressedSize = info.compressed_size;
+				QString key = QString::fromUtf8(name);
+				fEntries.insert(key, entry);
+#ifdef Q_OS_WIN
+				fFoldedEntries.insert(key.toLower(), key);
+#endif
+			}
+			result = unzGoToNextFile(fFile);
+		}
+		
+		if (fArchive.open(QIODevice::ReadOnly)) {
+			quint64 size = fArchive.size();
+			fMap = (const char *)fArchive.map(0, size);
+			if (fMap)
+				fMapSize = size;
+		}
 	}
 	
 	~ZipReader()
 	{
+		if (fMap)
+			fArchive.unmap((uchar *)fMap);
 		if (fFile)
 			unzClose(fFile);
 	}
@@ -825,15 +981,40 @@ public:
 		if (!fFile)
 			return false;
 		
-		unz_file_info info;
-		if ((unzLocateFile(fFile, name.toUtf8(), 0) != UNZ_OK) ||
-			(unzGetCurrentFileInfo(fFile, &info, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK) ||
+		QHash<QString, Entry>::const_iterator it = fEntries.constFind(name);
+		if (it == fEntries.constEnd()) {
+#ifdef Q_OS_WIN
+			// minizip matched names case insensitively on Windows
+			QHash<QString, QString>::const_iterator folded = fFoldedEntries.constFind(name.toLower());
+			if (folded == fFoldedEntries.constEnd())
+				return false;
+			it = fEntries.constFind(folded.value());
+#else
+			return false;
+#endif
+		}
+		const Entry& entry = it.value();
+		
+		// the index and the map are read only, so mapped entries need no locking
+		const char *source = mappedData(entry);
+		if (source) {
+			if (entry.fMethod == 0) {
+				data = QByteArray::fromRawData(source, entry.fSize);
+				return true;
+			}
+			if (entry.fMethod == Z_DEFLATED)
+				return inflateEntry(source, entry, data);
+		}
+		
+		QMutexLocker locker(&fLock);
+		unz_file_pos pos = entry.fPos;
+		if ((unzGoToFilePos(fFile, &pos) != UNZ_OK) ||
 			(unzOpenCurrentFile(fFile) != UNZ_OK)) {
 			return false;
 		}
 		
 		bool result = true;
-		data.resize(info.uncompressed_size);
+		data.resize(entry.fSize);
 		if (unzReadCurrentFile(fFile, data.data(), data.size()) != data.size())
 			result = false;
 		
@@ -852,7 +1033,76 @@ public:
 	}
 	
 private:
-	unzFile		fFile;
+	struct Entry {
+		unz_file_pos	fPos;
+		uLong			fMethod;
+		uLong			fFlags;
+		uLong			fSize;
+		uLong			fCompressedSize;
+	};
+	
+	static quint32 readLong(const char *data, int offset)
+	{
+		const uchar *p = (const uchar *)data + offset;
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((quint32)p[3] << 24);
+	}
+	
+	static quint16 readShort(const char *data, int offset)
+	{
+		const uchar *p = (const uchar *)data + offset;
+		return p[0] | (p[1] << 8);
+	}
+	
+	const char *mappedData(const Entry& entry)
+	{
+		// encrypted entries and archives with a prefix (self extracting) go through minizip
+		quint64 size = fMapSize;
+		if ((!fMap) || (entry.fFlags & 1) || ((quint64)entry.fPos.pos_in_zip_directory + 46 > size))
+			return NULL;
+		
+		const char *header = fMap + entry.fPos.pos_in_zip_directory;
+		if (readLong(header, 0) != 0x02014b50)
+			return NULL;
+		quint64 offset = readLong(header, 42);
+		if (offset + 30 > size)
+			return NULL;
+		
+		const char *local = fMap + offset;
+		if (readLong(local, 0) != 0x04034b50)
+			return NULL;
+		offset += 30 + readShort(local, 26) + readShort(local, 28);
+		if (offset + entry.fCompressedSize > size)
+			return NULL;
+		return fMap + offset;
+	}
+	
+	static bool inflateEntry(const char *source, const Entry& entry, QByteArray& data)
+	{
+		z_stream stream;
+		memset(&stream, 0, sizeof(stream));
+		if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+			return false;
+		
+		data.resize(entry.fSize);
+		stream.next_in = (Bytef *)source;
+		stream.avail_in = entry.fCompressedSize;
+		stream.next_out = (Bytef *)data.data();
+		stream.avail_out = entry.fSize;
+		int result = inflate(&stream, Z_FINISH);
+		inflateEnd(&stream);
+		
+		return (result == Z_STREAM_END) && (stream.total_out == entry.fSize);
+	}
+	
+	unzFile					fFile;
+	QFile					fArchive;
+	const char				*fMap;
+	quint64					fMapSize;
+	QMutex					fLock;
+	QHash<QString, Entry>	fEntries;
+#ifdef Q_OS_WIN
+	QHash<QString, QString>	fFoldedEntries;
+#endif
 };
 
 
@@ -880,10 +1130,112 @@ convertBuffer(PyObject *object, QByteArray *value)
 }
 
 
+static bool
+lookupSlots(PyObject *type, const char **names, Py_ssize_t *offsets, int count)
+{
+	int i;
+	
+	for (i = 0; i < count; i++)
+		offsets[i] = -1;
+	if ((!type) || (!PyType_Check(type)))
+		return false;
+	
+	for (i = 0; i < count; i++) {
+		PyObject *descr = PyDict_GetItemString(((PyTypeObject *)type)->tp_dict, names[i]);
+		if ((!descr) || (Py_TYPE(descr) != &PyMemberDescr_Type) || (((PyMemberDescrObject *)descr)->d_member->type != T_OBJECT_EX)) {
+			for (i = 0; i < count; i++)
+				offsets[i] = -1;
+			return false;
+		}
+		offsets[i] = ((PyMemberDescrObject *)descr)->d_member->offset;
+	}
+	return true;
+}
+
+
+static inline bool
+hasSlots(PyObject *object, PyObject *type, Py_ssize_t *offsets)
+{
+	return (offsets[0] >= 0) && (PyObject_TypeCheck(object, (PyTypeObject *)type));
+}
+
+
+static inline PyObject *
+getSlot(PyObject *object, Py_ssize_t offset)
+{
+	return *(PyObject **)((char *)object + offset);
+}
+
+
+static inline void
+setSlot(PyObject *object, Py_ssize_t offset, PyObject *value)
+{
+	PyObject **slot = (PyObject **)((char *)object + offset);
+	Py_XDECREF(*slot);
+	*slot = value;
+}
+
+
+static bool
+getSlotValue(PyObject *object, Py_ssize_t offset, double *value)
+{
+	PyObject *item = getSlot(object, offset);
+	if (!item)
+		return false;
+	if (PyFloat_CheckExact(item)) {
+		*value = PyFloat_AS_DOUBLE(item);
+	}
+	else if (PyInt_CheckExact(item)) {
+		*value = (double)PyInt_AS_LONG(item);
+	}
+	else {
+		*value = PyFloat_AsDouble(item);
+		if (PyErr_Occurred()) {
+			PyErr_Clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+
+static bool
+getSlotValue(PyObject *object, Py_ssize_t offset, int *value)
+{
+	PyObject *item = getSlot(object, offset);
+	if (!item)
+		return false;
+	if (PyInt_CheckExact(item)) {
+		*value = (int)PyInt_AS_LONG(item);
+	}
+	else if (PyFloat_CheckExact(item)) {
+		*value = (int)PyFloat_AS_DOUBLE(item);
+	}
+	else {
+		*value = (int)PyInt_AsLong(item);
+		if (PyErr_Occurred()) {
+			PyErr_Clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+
+static bool
+getVectorSlots(PyObject *object, double *x, double *y)
+{
+	return (hasSlots(object, sVectorType, sVectorSlots)) &&
+		(getSlotValue(object, sVectorSlots[0], x)) &&
+		(getSlotValue(object, sVectorSlots[1], y));
+}
+
+
 int
 convertPoint(PyObject *object, QPoint *value)
 {
 	int x, y;
+	double fx, fy;
 	
 	if (!object)
 		return 0;
@@ -892,7 +1244,12 @@ convertPoint(PyObject *object, QPoint *value)
 		*value = QPoint();
 		return 1;
 	}
-		
+	
+	if (getVectorSlots(object, &fx, &fy)) {
+		*value = QPoint((int)fx, (int)fy);
+		return 1;
+	}
+	
 	if ((!getObjectAttr(object, "x", &x)) ||
 		(!getObjectAttr(object, "y", &y)))
 		return 0;
@@ -914,7 +1271,12 @@ convertPointF(PyObject *object, QPointF *value)
 		*value = QPoint();
 		return 1;
 	}
-		
+	
+	if (getVectorSlots(object, &x, &y)) {
+		*value = QPointF(x, y);
+		return 1;
+	}
+	
 	if ((!getObjectAttr(object, "x", &x)) ||
 		(!getObjectAttr(object, "y", &y)))
 		return 0;
@@ -999,25 +1361,51 @@ convertIntList(PyObject *object, QList<int> *value)
 }
 
 
+#define SL_STRING_CACHE_SIZE			2048
+#define SL_STRING_CACHE_MAX_LENGTH		32
+
+static QHash<PyObject *, QString> sStringCache;
+static QHash<QString, PyObject *> sStringObjectCache;
+
+
+static QString
+unicodeToString(PyObject *object)
+{
+#if (Py_UNICODE_SIZE == 2)
+	return QString((const QChar *)PyUnicode_AS_UNICODE(object), (int)PyUnicode_GET_SIZE(object));
+#else
+	return QString::fromUcs4((const uint *)PyUnicode_AS_UNICODE(object), (int)PyUnicode_GET_SIZE(object));
+#endif
+}
+
+
 int
 convertString(PyObject *object, QString *value)
 {
 	if (!object)
 		return 0;
 	if (PyString_Check(object)) {
-		*value = QString::fromUtf8(PyString_AS_STRING(object));
+		// interned strings (identifiers, literals) are converted once and kept
+		if (PyString_CHECK_INTERNED(object)) {
+			QHash<PyObject *, QString>::const_iterator it = sStringCache.constFind(object);
+			if (it != sStringCache.constEnd()) {
+				*value = it.value();
+				return 1;
+			}
+		}
+		*value = QString::fromUtf8(PyString_AS_STRING(object), (int)PyString_GET_SIZE(object));
+		if ((PyString_CHECK_INTERNED(object)) && (PyString_GET_SIZE(object) <= SL_STRING_CACHE_MAX_LENGTH)) {
+			if (sStringCache.size() >= SL_STRING_CACHE_SIZE) {
+				foreach (PyObject *key, sStringCache.keys())
+					Py_DECREF(key);
+				sStringCache.clear();
+			}
+			Py_INCREF(object);
+			sStringCache.insert(object, *value);
+		}
 	}
 	else if (PyUnicode_Check(object)) {
-		wchar_t *buffer, *malloced = NULL;
-		size_t size = (size_t)PyUnicode_GET_SIZE(object);
-		if (size < 65536)
-			buffer = (wchar_t *)alloca(sizeof(wchar_t) * size);
-		else
-			buffer = malloced = (wchar_t *)malloc(sizeof(wchar_t) * size);
-		PyUnicode_AsWideChar((PyUnicodeObject *)object, buffer, (Py_ssize_t)size);
-		*value = QString::fromWCharArray(buffer, (int)size);
-		if (malloced)
-			free(malloced);
+		*value = unicodeToString(object);
 	}
 	else {
 		PyErr_SetString(PyExc_TypeError, "expected 'str' or 'unicode' object");
@@ -1039,6 +1427,15 @@ convertColor(PyObject *object, QColor *value)
 		return 1;
 	}
 	
+	if ((hasSlots(object, sColorType, sColorSlots)) &&
+		(getSlotValue(object, sColorSlots[0], &r)) &&
+		(getSlotValue(object, sColorSlots[1], &g)) &&
+		(getSlotValue(object, sColorSlots[2], &b)) &&
+		(getSlotValue(object, sColorSlots[3], &a))) {
+		*value = QColor(r, g, b, a);
+		return 1;
+	}
+	
 	PyObject *seq = PySequence_Fast(object, "expected tuple or list object");
 	if (seq) {
 		Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
@@ -1071,27 +1468,54 @@ convertColor(PyObject *object, QColor *value)
 }
 
 
-int
-convertFont(PyObject *object, QFont *value)
+class FontKey
 {
-	int family_id, size, style, spacing;
-	QString family, face;
-	QFont::StyleHint hint;
-	QFont::StyleStrategy strategy = (QFont::StyleStrategy)(QFont::PreferOutline | QFont::PreferAntialias);
-	QFont font;
+public:
+	FontKey(int family, const QString& face, int size, int style, int spacing)
+		: fFamily(family), fFace(face), fSize(size), fStyle(style), fSpacing(spacing) {}
 	
-	if (!object)
-		return 0;
-	if (object == Py_None) {
-		return 1;
+	bool operator==(const FontKey& other) const {
+		return (fFamily == other.fFamily) && (fSize == other.fSize) && (fStyle == other.fStyle) && (fSpacing == other.fSpacing) && (fFace == other.fFace);
 	}
 	
-	if ((!getObjectAttr(object, "family", &family_id)) ||
-		(!getObjectAttr(object, "face", &face)) ||
-		(!getObjectAttr(object, "size", &size)) ||
-		(!getObjectAttr(object, "style", &style)) ||
-		(!getObjectAttr(object, "spacing", &spacing)))
-		return 0;
+	int					fFamily;
+	QString				fFace;
+	int					fSize;
+	int					fStyle;
+	int					fSpacing;
+};
+
+
+inline uint
+qHash(const FontKey& key)
+{
+	return qHash(key.fFace) ^ (key.fFamily << 24) ^ (key.fSpacing << 16) ^ (key.fSize << 4) ^ key.fStyle;
+}
+
+
+class CachedFont
+{
+public:
+	CachedFont(const QFont& font) : fFont(font), fMetrics(font) {}
+	
+	QFont				fFont;
+	QFontMetricsF		fMetrics;
+};
+
+
+static QCache<FontKey, CachedFont> sFontCache(256);
+static QCache<QString, QPixmap> sImageCache(10 * 1024 * 1024);
+static quint64 sImageCacheHits = 0;
+static quint64 sImageCacheMisses = 0;
+
+
+static QFont
+createFont(int family_id, const QString& face, int size, int style, int spacing)
+{
+	QString family;
+	QFont::StyleHint hint;
+	QFont::StyleStrategy strategy = (QFont::StyleStrategy)(QFont::PreferOutline | QFont::PreferAntialias);
+	QFont font;
 	
 	if (family_id != SL_FONT_FAMILY_DEFAULT) {
 		switch (family_id) {
@@ -1129,27 +1553,102 @@ convertFont(PyObject *object, QFont *value)
 	font.setKerning(style & SL_FONT_STYLE_NO_KERNING ? false : true);
 	font.setLetterSpacing(QFont::AbsoluteSpacing, spacing);
 	
-	*value = font;
-	return 1;
+	return font;
 }
 
 
-int
-convertPixmap(PyObject *object, QPixmap *value)
+static CachedFont *
+lookupFont(PyObject *object)
 {
-	if (!object)
-		return 0;
-	if (object == Py_None) {
-		*value = QPixmap();
-		return 1;
-	}
-	if (PyObject_TypeCheck(object, (PyTypeObject *)sBitmapType)) {
-		DC_Proxy *proxy = (DC_Proxy *)PyObject_GetAttrString(object, "_impl");
-		if (proxy) {
-			*value = *((QPixmap *)proxy->fDevice);
-			Py_DECREF(proxy);
-			return 1;
-		}
+	int family_id, size, style, spacing;
+	QString face;
+	
+	PyObject *faceObj;
+	bool found = ((hasSlots(object, sFontType, sFontSlots)) &&
+		(getSlotValue(object, sFontSlots[0], &family_id)) &&
+		((faceObj = getSlot(object, sFontSlots[1])) != NULL) &&
+		(convertString(faceObj, &face)) &&
+		(getSlotValue(object, sFontSlots[2], &size)) &&
+		(getSlotValue(object, sFontSlots[3], &style)) &&
+		(getSlotValue(object, sFontSlots[4], &spacing)));
+	
+	if (!found) {
+		PyErr_Clear();
+		if ((!getObjectAttr(object, "family", &family_id)) ||
+			(!getObjectAttr(object, "face", &face)) ||
+			(!getObjectAttr(object, "size", &size)) ||
+			(!getObjectAttr(object, "style", &style)) ||
+			(!getObjectAttr(object, "spacing", &spacing)))
+			return NULL;
+	}
+	
+	FontKey key(family_id, face, size, style, spacing);
+	CachedFont *cached = sFontCache.object(key);
+	if (!cached) {
+		cached = new CachedFont(createFont(family_id, face, size, style, spacing));
+		sFontCache.insert(key, cached);
+	}
+	return cached;
+}
+
+
+void
+clearFontCache()
+{
+	PyAutoLocker locker;
+	sFontCache.clear();
+}
+
+
+int
+convertFont(PyObject *object, QFont *value)
+{
+	if (!object)
+		return 0;
+	if (object == Py_None) {
+		return 1;
+	}
+	
+	CachedFont *cached = lookupFont(object);
+	if (!cached)
+		return 0;
+	*value = cached->fFont;
+	return 1;
+}
+
+
+QFontMetricsF
+getFontMetrics(PyObject *object)
+{
+	if ((object) && (object != Py_None)) {
+		CachedFont *cached = lookupFont(object);
+		if (cached)
+			return cached->fMetrics;
+	}
+	return QFontMetricsF(QFont());
+}
+
+
+int
+convertPixmap(PyObject *object, QPixmap *value)
+{
+	if (!object)
+		return 0;
+	if (object == Py_None) {
+		*value = QPixmap();
+		return 1;
+	}
+	if (PyObject_TypeCheck(object, (PyTypeObject *)sBitmapType)) {
+		DC_Proxy *proxy = (DC_Proxy *)PyObject_GetAttrString(object, "_impl");
+		if (proxy) {
+			endDCPainter(proxy);
+			if (proxy->fDevice->devType() == QInternal::Image)
+				*value = QPixmap::fromImage(*((QImage *)proxy->fDevice));
+			else
+				*value = *((QPixmap *)proxy->fDevice);
+			Py_DECREF(proxy);
+			return 1;
+		}
 		PyErr_Clear();
 	}
 	PyErr_SetString(PyExc_TypeError, "expected 'Bitmap' object");
@@ -1169,6 +1668,7 @@ convertPicture(PyObject *object, QPicture *value)
 	if (PyObject_TypeCheck(object, (PyTypeObject *)sPictureType)) {
 		DC_Proxy *proxy = (DC_Proxy *)PyObject_GetAttrString(object, "_impl");
 		if (proxy) {
+			endDCPainter(proxy);
 			*value = *((QPicture *)proxy->fDevice);
 			Py_DECREF(proxy);
 			return 1;
@@ -1598,14 +2098,31 @@ createBufferObject(const QByteArray& data)
 PyObject *
 createVectorObject(const QPoint& point)
 {
-	return PyObject_CallFunction(sVectorType, "ii", point.x(), point.y());
+	return createVectorObject(QPointF(point));
 }
 
 
 PyObject *
 createVectorObject(const QPointF& point)
 {
-	return PyObject_CallFunction(sVectorType, "dd", point.x(), point.y());
+	if (sVectorSlots[0] < 0)
+		return PyObject_CallFunction(sVectorType, "dd", point.x(), point.y());
+	
+	// fill the slots directly, skipping the Python constructor
+	PyObject *object = ((PyTypeObject *)sVectorType)->tp_alloc((PyTypeObject *)sVectorType, 0);
+	if (!object)
+		return NULL;
+	PyObject *x = PyFloat_FromDouble(point.x());
+	PyObject *y = PyFloat_FromDouble(point.y());
+	if ((!x) || (!y)) {
+		Py_XDECREF(x);
+		Py_XDECREF(y);
+		Py_DECREF(object);
+		return NULL;
+	}
+	setSlot(object, sVectorSlots[0], x);
+	setSlot(object, sVectorSlots[1], y);
+	return object;
 }
 
 
@@ -1644,11 +2161,71 @@ createIntListObject(const QList<int>& list)
 }
 
 
+static PyObject *
+stringToUnicode(const QString& string)
+{
+#if (Py_UNICODE_SIZE == 2)
+	return PyUnicode_FromUnicode((const Py_UNICODE *)string.utf16(), string.size());
+#else
+	const ushort *utf16 = string.utf16();
+	int i, j, length = string.size(), size = length;
+	
+	for (i = 0; i < length - 1; i++) {
+		if ((QChar::isHighSurrogate(utf16[i])) && (QChar::isLowSurrogate(utf16[i + 1]))) {
+			size--;
+			i++;
+		}
+	}
+	
+	PyObject *object = PyUnicode_FromUnicode(NULL, size);
+	if (!object)
+		return NULL;
+	Py_UNICODE *buffer = PyUnicode_AS_UNICODE(object);
+	for (i = 0, j = 0; i < length; i++, j++) {
+		if ((i < length - 1) && (QChar::isHighSurrogate(utf16[i])) && (QChar::isLowSurrogate(utf16[i + 1]))) {
+			buffer[j] = QChar::surrogateToUcs4(utf16[i], utf16[i + 1]);
+			i++;
+		}
+		else {
+			buffer[j] = utf16[i];
+		}
+	}
+	return object;
+#endif
+}
+
+
 PyObject *
 createStringObject(const QString& string)
 {
-	QByteArray data = string.toUtf8();
-	return PyUnicode_DecodeUTF8(data.data(), data.size(), NULL);
+	return stringToUnicode(string);
+}
+
+
+PyObject *
+createInternedStringObject(const QString& string)
+{
+	if (string.size() > SL_STRING_CACHE_MAX_LENGTH)
+		return stringToUnicode(string);
+	
+	// only for a bounded set of repeated strings, such as formats and names
+	QHash<QString, PyObject *>::const_iterator it = sStringObjectCache.constFind(string);
+	if (it != sStringObjectCache.constEnd()) {
+		Py_INCREF(it.value());
+		return it.value();
+	}
+	
+	PyObject *object = stringToUnicode(string);
+	if (!object)
+		return NULL;
+	if (sStringObjectCache.size() >= SL_STRING_CACHE_SIZE) {
+		foreach (PyObject *cached, sStringObjectCache)
+			Py_DECREF(cached);
+		sStringObjectCache.clear();
+	}
+	Py_INCREF(object);
+	sStringObjectCache.insert(string, object);
+	return object;
 }
 
 
@@ -1658,7 +2235,17 @@ createColorObject(const QColor& color)
 	if (!color.isValid())
 		Py_RETURN_NONE;
 	
-	return PyObject_CallFunction(sColorType, "iiii", color.red(), color.green(), color.blue(), color.alpha());
+	if (sColorSlots[0] < 0)
+		return PyObject_CallFunction(sColorType, "iiii", color.red(), color.green(), color.blue(), color.alpha());
+	
+	PyObject *object = ((PyTypeObject *)sColorType)->tp_alloc((PyTypeObject *)sColorType, 0);
+	if (!object)
+		return NULL;
+	setSlot(object, sColorSlots[0], PyInt_FromLong(color.red()));
+	setSlot(object, sColorSlots[1], PyInt_FromLong(color.green()));
+	setSlot(object, sColorSlots[2], PyInt_FromLong(color.blue()));
+	setSlot(object, sColorSlots[3], PyInt_FromLong(color.alpha()));
+	return object;
 }
 
 
@@ -1684,7 +2271,23 @@ createFontObject(const QFont& font, bool system)
 	
 	int spacing = font.letterSpacing();
 	
-	return PyObject_CallFunction(sFontType, "isiii", family, (const char *)face.toUtf8(), size, style, spacing);
+	if (sFontSlots[0] < 0)
+		return PyObject_CallFunction(sFontType, "isiii", family, (const char *)face.toUtf8(), size, style, spacing);
+	
+	PyObject *object = ((PyTypeObject *)sFontType)->tp_alloc((PyTypeObject *)sFontType, 0);
+	if (!object)
+		return NULL;
+	PyObject *faceObj = PyString_FromString(face.toUtf8());
+	if (!faceObj) {
+		Py_DECREF(object);
+		return NULL;
+	}
+	setSlot(object, sFontSlots[0], PyInt_FromLong(family));
+	setSlot(object, sFontSlots[1], faceObj);
+	setSlot(object, sFontSlots[2], PyInt_FromLong(size));
+	setSlot(object, sFontSlots[3], PyInt_FromLong(style));
+	setSlot(object, sFontSlots[4], PyInt_FromLong(spacing));
+	return object;
 }
 
 
@@ -1710,29 +2313,64 @@ createDCObject(QPainter *painter, PyObject *objectType, PyObject *proxyType, QPa
 	proxy->fDevice = device;
 	proxy->fPainter = painter;
 	proxy->fBaseTransform = baseTransform;
+	proxy->fState = NULL;
 	Py_DECREF(proxy);
 	
 	return object;
 }
 
 
+static PyObject *
+createDeviceObject(PyObject *objectType, PyTypeObject *proxyType, QPaintDevice *device)
+{
+	// wraps the device directly, without running the python __init__ that would allocate a throwaway one
+	PyTypeObject *type = (PyTypeObject *)objectType;
+	PyObject *args = PyTuple_New(0);
+	PyObject *object = args ? type->tp_new(type, args, NULL) : NULL;
+	Py_XDECREF(args);
+	if (!object) {
+		delete device;
+		return NULL;
+	}
+	
+	DC_Proxy *proxy = (DC_Proxy *)proxyType->tp_alloc(proxyType, 0);
+	if (!proxy) {
+		Py_DECREF(object);
+		delete device;
+		return NULL;
+	}
+	proxy->fDevice = device;
+	proxy->fPainter = NULL;
+	proxy->fBaseTransform = NULL;
+	proxy->fState = NULL;
+	
+	int result = PyObject_SetAttrString(object, "_impl", (PyObject *)proxy);
+	Py_DECREF(proxy);
+	if (result < 0) {
+		Py_DECREF(object);
+		return NULL;
+	}
+	return object;
+}
+
+
 PyObject *
 createBitmapObject(const QPixmap& pixmap)
 {
 	if (pixmap.isNull())
 		Py_RETURN_NONE;
 	
-	PyObject *object = PyObject_CallFunctionObjArgs(sBitmapType, NULL);
-	if (!object)
-		return NULL;
-	
-	DC_Proxy *proxy = (DC_Proxy *)PyObject_GetAttrString(object, "_impl");
-	proxy->fPainter->end();
-	*((QPixmap *)proxy->fDevice) = pixmap;
-	proxy->fPainter->begin(proxy->fDevice);
-	Py_DECREF(proxy);
+	return createDeviceObject(sBitmapType, &Bitmap_Type, new QPixmap(pixmap));
+}
+
+
+PyObject *
+createBitmapObject(const QImage& image)
+{
+	if (image.isNull())
+		Py_RETURN_NONE;
 	
-	return object;
+	return createDeviceObject(sBitmapType, &Bitmap_Type, new QPixmap(QPixmap::fromImage(image)));
 }
 
 
@@ -1742,17 +2380,7 @@ createPictureObject(const QPicture& picture)
 	if (picture.isNull())
 		Py_RETURN_NONE;
 	
-	PyObject *object = PyObject_CallFunctionObjArgs(sPictureType, NULL);
-	if (!object)
-		return NULL;
-	
-	DC_Proxy *proxy = (DC_Proxy *)PyObject_GetAttrString(object, "_impl");
-	proxy->fPainter->end();
-	*((QPicture *)proxy->fDevice) = picture;
-	proxy->fPainter->begin(proxy->fDevice);
-	Py_DECREF(proxy);
-	
-	return object;
+	return createDeviceObject(sPictureType, &Picture_Type, new QPicture(picture));
 }
 
 
@@ -1896,6 +2524,103 @@ centerWindow(QWidget *window, QWidget *parent)
 }
 
 
+void
+registerShortcut(QObject *owner, const QKeySequence& key)
+{
+	unregisterShortcut(owner);
+	if (!key.isEmpty())
+		sShortcuts.insert(key[0], owner);
+}
+
+
+void
+unregisterShortcut(QObject *owner)
+{
+	QMultiHash<int, QPointer<QObject> >::iterator it = sShortcuts.begin();
+	while (it != sShortcuts.end()) {
+		if ((!it.value()) || (it.value() == owner))
+			it = sShortcuts.erase(it);
+		else
+			++it;
+	}
+}
+
+
+static bool
+isShortcutContextActive(Qt::ShortcutContext context, QWidget *widget, QWidget *focus)
+{
+	switch (context) {
+	case Qt::ApplicationShortcut:
+		return true;
+	case Qt::WindowShortcut:
+		return widget->window() == focus->window();
+	case Qt::WidgetWithChildrenShortcut:
+		return (widget == focus) || (widget->isAncestorOf(focus));
+	case Qt::WidgetShortcut:
+		return widget == focus;
+	}
+	return false;
+}
+
+
+static bool
+isActionShortcutActive(QAction *action, Qt::ShortcutContext context, QWidget *focus, int depth = 0)
+{
+	if ((!action->isEnabled()) || (depth > 8))
+		return false;
+	if (context == Qt::ApplicationShortcut)
+		return true;
+	foreach (QWidget *widget, action->associatedWidgets()) {
+		QMenu *menu = qobject_cast<QMenu *>(widget);
+		if (menu) {
+			// menu actions are active through the menubar or menu they belong to
+			if (isActionShortcutActive(menu->menuAction(), context, focus, depth + 1))
+				return true;
+		}
+		else if (isShortcutContextActive(context, widget, focus))
+			return true;
+	}
+	return false;
+}
+
+
+bool
+isShortcutBound(QKeyEvent *event, QWidget *focus)
+{
+	int key = event->key();
+	switch (key) {
+	case 0:
+	case Qt::Key_unknown:
+	case Qt::Key_Shift:
+	case Qt::Key_Control:
+	case Qt::Key_Meta:
+	case Qt::Key_Alt:
+	case Qt::Key_AltGr:
+		return false;
+	default:
+		break;
+	}
+	
+	int combo = key | (event->modifiers() & ~Qt::KeypadModifier);
+	QMultiHash<int, QPointer<QObject> >::const_iterator it = sShortcuts.constFind(combo);
+	for (; (it != sShortcuts.constEnd()) && (it.key() == combo); ++it) {
+		QObject *owner = it.value();
+		if (!owner)
+			continue;
+		QShortcut *shortcut = qobject_cast<QShortcut *>(owner);
+		if (shortcut) {
+			if ((shortcut->isEnabled()) && (shortcut->parentWidget()) && (isShortcutContextActive(shortcut->context(), shortcut->parentWidget(), focus)))
+				return true;
+			continue;
+		}
+		QAction *action = qobject_cast<QAction *>(owner);
+		if ((action) && (isActionShortcutActive(action, action->shortcutContext(), focus)))
+			return true;
+	}
+	return false;
+}
+
+
 void
 setShortcut(QWidget *widget, const QString& sequence, Qt::ShortcutContext context, PyObject *callback)
 {
@@ -1914,34 +2639,16 @@ setShortcut(QWidget *widget, const QString& sequence, Qt::ShortcutContext contex
 }
 
 
-void
-setTimeout(QObject *object, int delay, PyObject *func, PyObject *args)
+int
+setTimeout(QObject *object, int delay, PyObject *func, PyObject *args, bool periodic)
 {
 	PyAutoLocker locker;
-	TimedCall *timedCall = NULL;
 	
-	if (object) {
-		foreach (QObject *child, object->children()) {
-			timedCall = qobject_cast<TimedCall *>(child);
-			if (timedCall)
-				break;
-		}
-		if (timedCall) {
-			timedCall->stop();
-			timedCall->setParent(NULL);
-			timedCall->deleteLater();
-		}
-	}
-	
-	timedCall = new TimedCall(object, func, args);
-	timedCall->moveToThread(QApplication::instance()->thread());
-	timedCall->setParent(object);
-	if (delay == 0) {
-		QMetaObject::invokeMethod(timedCall, "executeAndDelete", Qt::QueuedConnection);
-	}
-	else {
-		QMetaObject::invokeMethod(timedCall, "start", Qt::AutoConnection, Q_ARG(int, delay));
+	if ((!object) && (delay == 0) && (!periodic)) {
+		sCallQueue.post(func, args);
+		return 0;
 	}
+	return SL_QAPP()->timerWheel()->add(object, delay, func, args, periodic);
 }
 
 
@@ -1954,6 +2661,24 @@ loadResource(const QString& resource, QByteArray& data)
 }
 
 
+static qreal
+devicePixelRatio()
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+	return qApp->devicePixelRatio();
+#else
+	return 1.0;
+#endif
+}
+
+
+static QString
+imageCacheKey(const QString& name, const QSize& size)
+{
+	return QString("%1|%2x%3@%4").arg(name).arg(size.width()).arg(size.height()).arg(devicePixelRatio());
+}
+
+
 bool
 openURI(const QString& uri)
 {
@@ -2251,7 +2976,7 @@ mimeDataToObject(const QMimeData *mimeData, const QString& mimeType)
 		}
 		else if (mimeData->hasImage()) {
 			QImage image = qvariant_cast<QImage>(mimeData->imageData());
-			object = createBitmapObject(QPixmap::fromImage(image));
+			object = createBitmapObject(image);
 		}
 		else if (mimeData->hasFormat(SL_PYOBJECT_MIME_TYPE)) {
 			QByteArray array = mimeData->data(SL_PYOBJECT_MIME_TYPE);
@@ -2268,7 +2993,7 @@ mimeDataToObject(const QMimeData *mimeData, const QString& mimeType)
 		QString _mimeType = mimeType;
 		if (_mimeType == "image/*") {
 			QImage image = qvariant_cast<QImage>(mimeData->imageData());
-			object = createBitmapObject(QPixmap::fromImage(image));
+			object = createBitmapObject(image);
 		}
 		else if (mimeData->formats().contains(_mimeType)) {
 			QByteArray array = mimeData->data(_mimeType);
@@ -2458,28 +3183,513 @@ getKeyCode(int key)
 	case Qt::Key_Tab:		return SL_KEY_TAB;
 	case Qt::Key_Escape:	return SL_KEY_ESCAPE;
 	}
-	return key < 256 ? key : 0;
+	return key < 256 ? key : 0;
+}
+
+
+QLocale
+getLocale()
+{
+	return sLocale;
+}
+
+
+void
+freeBitmapResources(QPainter *painter, QPaintDevice *device)
+{
+	QApplication::postEvent(qApp, new FreeBitmapResourcesEvent(painter, device));
+}
+
+
+void
+scheduleCloseDCPainters()
+{
+	QApplication::postEvent(qApp, new QEvent(sCloseDCPaintersEvent), Qt::LowEventPriority);
+}
+
+
+EventCoalescer::EventCoalescer(QObject *parent)
+	: QObject(parent), fInterval(-1)
+{
+	fTimer = new QTimer(this);
+	fTimer->setSingleShot(true);
+	connect(fTimer, SIGNAL(timeout()), this, SLOT(handleTimeout()));
+}
+
+
+EventCoalescer::~EventCoalescer()
+{
+	foreach (Pending *pending, fPending) {
+		if (Py_IsInitialized()) {
+			PyAutoLocker locker;
+			Py_DECREF(pending->fParams);
+		}
+		delete pending;
+	}
+}
+
+
+void
+EventCoalescer::setInterval(int interval)
+{
+	fInterval = interval;
+	if (fInterval < 0)
+		deliver();
+}
+
+
+bool
+EventCoalescer::post(QObject *target, EventRunner& runner)
+{
+	if ((fInterval < 0) || (!runner.isHandled()))
+		return false;
+	
+	QString name = runner.name();
+	EventFields fields = runner.fields();
+	Pending *pending = NULL;
+	
+	foreach (Pending *p, fPending) {
+		if ((p->fTarget == target) && (p->fName == name)) {
+			pending = p;
+			break;
+		}
+	}
+	if (pending) {
+		// wheel deltas are summed, everything else just keeps the latest values
+		if (fields.contains("delta"))
+			fields["delta"] = fields.value("delta").toInt() + pending->fFields.value("delta").toInt();
+		Py_DECREF(pending->fParams);
+		fDropped[name]++;
+	}
+	else {
+		pending = new Pending;
+		pending->fTarget = target;
+		pending->fName = name;
+		fPending.append(pending);
+	}
+	pending->fParams = PyDict_Copy(runner.params());
+	pending->fFields = fields;
+	
+	if (!fTimer->isActive()) {
+		int wait = 0;
+		if ((fInterval > 0) && (fLastDelivery.isValid()))
+			wait = qMax(0, fInterval - (int)fLastDelivery.elapsed());
+		fTimer->start(wait);
+	}
+	return true;
+}
+
+
+void
+EventCoalescer::deliver(QObject *target)
+{
+	QList<Pending *> list;
+	
+	if (fPending.isEmpty())
+		return;
+	
+	if (target) {
+		for (int i = fPending.count() - 1; i >= 0; i--) {
+			if (fPending[i]->fTarget == target)
+				list.prepend(fPending.takeAt(i));
+		}
+		if (list.isEmpty())
+			return;
+	}
+	else {
+		list = fPending;
+		fPending.clear();
+		fTimer->stop();
+		fLastDelivery.start();
+	}
+	
+	PyAutoLocker locker;
+	
+	foreach (Pending *pending, list) {
+		if (pending->fTarget) {
+			EventRunner runner(pending->fTarget, pending->fName);
+			if (runner.isValid()) {
+				runner.assign(pending->fParams, pending->fFields);
+				runner.run();
+				fDelivered[pending->fName]++;
+			}
+		}
+		Py_DECREF(pending->fParams);
+		delete pending;
+	}
+}
+
+
+PyObject *
+EventCoalescer::getStats(bool reset)
+{
+	QStringList names = fDelivered.keys();
+	PyObject *dict = PyDict_New();
+	
+	foreach (const QString& name, fDropped.keys()) {
+		if (!fDelivered.contains(name))
+			names.append(name);
+	}
+	
+	foreach (const QString& name, names) {
+		PyObject *entry = PyDict_New();
+		PyObject *value = PyLong_FromUnsignedLongLong(fDelivered.value(name));
+		PyDict_SetItemString(entry, "delivered", value);
+		Py_DECREF(value);
+		value = PyLong_FromUnsignedLongLong(fDropped.value(name));
+		PyDict_SetItemString(entry, "dropped", value);
+		Py_DECREF(value);
+		PyDict_SetItemString(dict, name.toUtf8(), entry);
+		Py_DECREF(entry);
+	}
+	if (reset) {
+		fDelivered.clear();
+		fDropped.clear();
+	}
+	return dict;
+}
+
+
+void
+EventCoalescer::handleTimeout()
+{
+	deliver();
+}
+
+
+TimerWheel::TimerWheel(QObject *parent)
+	: QObject(parent), fCurrent(0), fLastID(0)
+{
+	memset(fSlots, 0, sizeof(fSlots));
+	fClock.start();
+	fTimer = new QTimer(this);
+	fTimer->setSingleShot(true);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+	fTimer->setTimerType(Qt::PreciseTimer);
+#endif
+	connect(fTimer, SIGNAL(timeout()), this, SLOT(handleTimeout()));
+}
+
+
+TimerWheel::~TimerWheel()
+{
+	foreach (Entry *entry, fTimers)
+		release(entry);
+}
+
+
+int
+TimerWheel::add(QObject *owner, int delay, PyObject *func, PyObject *args, bool periodic)
+{
+	Entry *entry = new Entry;
+	Entry *previous = NULL;
+	int id;
+	
+	delay = qMax(0, delay);
+	Py_XINCREF(func);
+	Py_XINCREF(args);
+	entry->fNext = NULL;
+	entry->fPrev = NULL;
+	entry->fInterval = periodic ? qMax(1, (delay + kTick - 1) / kTick) : 0;
+	entry->fCancelled = false;
+	entry->fOwner = owner;
+	entry->fGuard = owner;
+	entry->fFunc = func;
+	entry->fArgs = args;
+	
+	{
+		QMutexLocker locker(&fMutex);
+		
+		if (fTimers.isEmpty())
+			fCurrent = now();
+		if (owner) {
+			previous = fOwned.value(owner);
+			if (previous)
+				previous = detach(previous);
+			fOwned[owner] = entry;
+		}
+		if (++fLastID <= 0)
+			fLastID = 1;
+		id = entry->fID = fLastID;
+		entry->fExpires = ((quint64)fClock.elapsed() + delay + kTick - 1) / kTick;
+		fTimers[id] = entry;
+		link(entry);
+	}
+	
+	if (previous)
+		release(previous);
+	if (owner)
+		connect(owner, SIGNAL(destroyed(QObject *)), this, SLOT(handleOwnerDestroyed(QObject *)), Qt::UniqueConnection);
+	
+	if (QThread::currentThread() == thread())
+		reschedule();
+	else
+		QMetaObject::invokeMethod(this, "reschedule", Qt::QueuedConnection);
+	return id;
+}
+
+
+bool
+TimerWheel::cancel(int id)
+{
+	Entry *entry;
+	{
+		QMutexLocker locker(&fMutex);
+		
+		entry = fTimers.value(id);
+		if (!entry)
+			return false;
+		entry = detach(entry);
+	}
+	if (entry)
+		release(entry);
+	return true;
+}
+
+
+void
+TimerWheel::cancelOwner(QObject *owner)
+{
+	Entry *entry;
+	{
+		QMutexLocker locker(&fMutex);
+		
+		entry = fOwned.value(owner);
+		if (entry)
+			entry = detach(entry);
+	}
+	if (entry)
+		release(entry);
+}
+
+
+int
+TimerWheel::pending()
+{
+	QMutexLocker locker(&fMutex);
+	
+	return fTimers.size();
+}
+
+
+void
+TimerWheel::link(Entry *entry)
+{
+	quint64 expires = qMax(entry->fExpires, fCurrent);
+	quint64 delta = expires - fCurrent;
+	int level = 0;
+	
+	while ((level < kLevels - 1) && (delta >= ((quint64)1 << (kBits * (level + 1)))))
+		level++;
+	if (delta >= ((quint64)1 << (kBits * kLevels)))
+		expires = fCurrent + ((quint64)1 << (kBits * kLevels)) - 1;
+	
+	Entry **slot = &fSlots[level][(expires >> (kBits * level)) & kMask];
+	entry->fExpires = expires;
+	entry->fNext = *slot;
+	entry->fPrev = slot;
+	if (*slot)
+		(*slot)->fPrev = &entry->fNext;
+	*slot = entry;
+}
+
+
+void
+TimerWheel::unlink(Entry *entry)
+{
+	*entry->fPrev = entry->fNext;
+	if (entry->fNext)
+		entry->fNext->fPrev = entry->fPrev;
+	entry->fNext = NULL;
+	entry->fPrev = NULL;
+}
+
+
+TimerWheel::Entry *
+TimerWheel::detach(Entry *entry)
+{
+	fTimers.remove(entry->fID);
+	if ((entry->fOwner) && (fOwned.value(entry->fOwner) == entry))
+		fOwned.remove(entry->fOwner);
+	
+	if (entry->fPrev) {
+		unlink(entry);
+		return entry;
+	}
+	// currently being fired, handleTimeout() will dispose of it
+	entry->fCancelled = true;
+	return NULL;
+}
+
+
+void
+TimerWheel::release(Entry *entry)
+{
+	if (Py_IsInitialized()) {
+		PyAutoLocker locker;
+		Py_XDECREF(entry->fFunc);
+		Py_XDECREF(entry->fArgs);
+	}
+	delete entry;
+}
+
+
+void
+TimerWheel::advance(quint64 tick, QList<Entry *>& expired)
+{
+	while (fCurrent <= tick) {
+		int index = fCurrent & kMask;
+		Entry *entry;
+		
+		// at every wrap of a level, redistribute the next slot of the upper level
+		if (index == 0) {
+			for (int level = 1; level < kLevels; level++) {
+				int slot = (fCurrent >> (kBits * level)) & kMask;
+				entry = fSlots[level][slot];
+				fSlots[level][slot] = NULL;
+				while (entry) {
+					Entry *next = entry->fNext;
+					link(entry);
+					entry = next;
+				}
+				if (slot != 0)
+					break;
+			}
+		}
+		
+		entry = fSlots[0][index];
+		fSlots[0][index] = NULL;
+		while (entry) {
+			Entry *next = entry->fNext;
+			entry->fNext = NULL;
+			entry->fPrev = NULL;
+			expired.append(entry);
+			entry = next;
+		}
+		fCurrent++;
+	}
+}
+
+
+qint64
+TimerWheel::nextWake()
+{
+	if (fTimers.isEmpty())
+		return -1;
+	for (quint64 tick = fCurrent;; tick++) {
+		if (((tick & kMask) == 0) || (fSlots[0][tick & kMask]))
+			return tick;
+	}
+}
+
+
+void
+TimerWheel::fire(Entry *entry)
+{
+	bool cancelled;
+	{
+		QMutexLocker locker(&fMutex);
+		cancelled = entry->fCancelled;
+	}
+	
+	if (!cancelled) {
+		if (entry->fOwner) {
+			QObject *owner = entry->fGuard;
+			if (owner) {
+				EventRunner runner(owner, "onTimer");
+				if (runner.isHandled()) {
+					if (entry->fArgs)
+						runner.set("args", entry->fArgs, false);
+					else
+						runner.set("args", PyTuple_New(0));
+					runner.run();
+				}
+			}
+		}
+		else {
+			PyObject *result = PyObject_CallObject(entry->fFunc, entry->fArgs);
+			if (!result) {
+				PyErr_Print();
+				PyErr_Clear();
+			}
+			else {
+				Py_DECREF(result);
+			}
+		}
+	}
+	
+	{
+		QMutexLocker locker(&fMutex);
+		
+		if (!entry->fCancelled) {
+			if ((entry->fInterval > 0) && ((!entry->fOwner) || (entry->fGuard))) {
+				entry->fExpires += entry->fInterval;
+				link(entry);
+				return;
+			}
+			fTimers.remove(entry->fID);
+			if ((entry->fOwner) && (fOwned.value(entry->fOwner) == entry))
+				fOwned.remove(entry->fOwner);
+		}
+	}
+	release(entry);
 }
 
 
-QLocale
-getLocale()
+void
+TimerWheel::reschedule()
 {
-	return sLocale;
+	qint64 tick;
+	{
+		QMutexLocker locker(&fMutex);
+		tick = nextWake();
+	}
+	if (tick < 0)
+		fTimer->stop();
+	else
+		fTimer->start((int)qMax((qint64)0, (tick * kTick) - fClock.elapsed()));
 }
 
 
 void
-freeBitmapResources(QPainter *painter, QPaintDevice *device)
+TimerWheel::handleTimeout()
 {
-	QApplication::postEvent(qApp, new FreeBitmapResourcesEvent(painter, device));
+	QList<Entry *> expired;
+	{
+		QMutexLocker locker(&fMutex);
+		
+		if (fTimers.isEmpty())
+			fCurrent = now();
+		else
+			advance(now(), expired);
+	}
+	
+	if (!expired.isEmpty()) {
+		PyAutoLocker locker;
+		
+		qSort(expired.begin(), expired.end(), lessThan);
+		foreach (Entry *entry, expired)
+			fire(entry);
+	}
+	reschedule();
+}
+
+
+void
+TimerWheel::handleOwnerDestroyed(QObject *owner)
+{
+	cancelOwner(owner);
 }
 
 
 Application::Application(int& argc, char **argv)
-	: QApplication(argc, argv), fWID(0)
+	: QApplication(argc, argv)
 {
+	sProxyDataID = QObject::registerUserData();
+	sInterfaceDataID = QObject::registerUserData();
 	fMutex = new QMutex(QMutex::Recursive);
+	fCoalescer = new EventCoalescer(this);
+	fTimerWheel = new TimerWheel(this);
 	fShadowWindow = new QMainWindow;
 	fShadowWindow->setAttribute(Qt::WA_DontShowOnScreen);
 	fShadowWindow->setAttribute(Qt::WA_QuitOnClose, false);
@@ -2502,6 +3712,8 @@ Application::Application(int& argc, char **argv)
 	
 	sExceptionEvent = (QEvent::Type)QEvent::registerEventType();
 	sFreeBitmapResourcesEvent = (QEvent::Type)QEvent::registerEventType();
+	sCallQueueEvent = (QEvent::Type)QEvent::registerEventType();
+	sCloseDCPaintersEvent = (QEvent::Type)QEvent::registerEventType();
 	
 	installEventFilter(this);
 	QNetworkProxyFactory::setUseSystemConfiguration(true);
@@ -2583,9 +3795,75 @@ private:
 QAtomicInt NotifyCounter::sInNotify;
 
 
+class InterfaceData : public QObjectUserData
+{
+public:
+	InterfaceData() : fGeneration(-1), fWidget(NULL), fImpl(NULL) {}
+	
+	int					fGeneration;
+	QWidget				*fWidget;
+	WidgetInterface		*fImpl;
+};
+
+
+static bool
+isInterfaceEvent(QEvent::Type type)
+{
+	// all the event types WidgetInterface::isModifyEvent() and isFocusOutEvent() may care about
+	switch (type) {
+	case QEvent::KeyPress:
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+	case QEvent::MouseButtonDblClick:
+	case QEvent::Wheel:
+	case QEvent::TouchBegin:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+static WidgetInterface *
+findWidgetInterface(QWidget *widget, QWidget **current)
+{
+	InterfaceData *data = (InterfaceData *)widget->userData(sInterfaceDataID);
+	if ((data) && (data->fGeneration == sHierarchyGeneration)) {
+		*current = data->fWidget;
+		return data->fImpl;
+	}
+	
+	WidgetInterface *impl;
+	QWidget *w = widget;
+	do {
+		impl = dynamic_cast<WidgetInterface *>(w);
+		if (!impl)
+			w = w->parentWidget();
+	} while ((!impl) && (w));
+	
+	if (!data) {
+		data = new InterfaceData;
+		widget->setUserData(sInterfaceDataID, data);
+	}
+	data->fGeneration = sHierarchyGeneration;
+	data->fWidget = w;
+	data->fImpl = impl;
+	*current = w;
+	return impl;
+}
+
+
 bool
 Application::notify(QObject *receiver, QEvent *event)
 {
+	if (event->type() == QEvent::ParentChange)
+		sHierarchyGeneration++;
+	
+	if ((!isInterfaceEvent(event->type())) || (!receiver->isWidgetType())) {
+		NotifyCounter notifyCounter;
+		return QApplication::notify(receiver, event);
+	}
+	
 	QPointer<QObject> original = receiver;
 	QPointer<QWidget> target = qobject_cast<QWidget *>(receiver);
 	NotifyCounter notifyCounter;
@@ -2596,25 +3874,16 @@ Application::notify(QObject *receiver, QEvent *event)
 	
 		while (target->focusProxy())
 			target = target->focusProxy();
-		QWidget *current = target;
-		WidgetInterface *impl;
-// 		qDebug() << "impl is" << impl << receiver;
-		do {
-			impl = dynamic_cast<WidgetInterface *>(current);
-			if (!impl)
-				current = current->parentWidget();
-		} while ((!impl) && (current));
+		QWidget *current;
+		WidgetInterface *impl = findWidgetInterface(target, &current);
 		
 // 		qDebug() << "---" << current << event;
 		if (impl) {
 			if (event->type() == QEvent::KeyPress) {
-				QKeyEvent *e = (QKeyEvent *)event;
-				sShortcutTestEvent = QKeyEvent(QEvent::KeyPress, e->key(), e->modifiers(), e->text(), e->isAutoRepeat(), e->count());
-				sShortcutTestEvent.ignore();
-				QApplication::notify(receiver, &sShortcutTestEvent);
-				bool accepted = sShortcutTestEvent.isAccepted();
-				sShortcutTestEvent = QKeyEvent(QEvent::None, 0, Qt::NoModifier);
-				if ((!accepted) && (impl->isModifyEvent(event)) && (!impl->canModify(current)))
+				bool bound = isShortcutBound((QKeyEvent *)event, target);
+				if (bound)
+					hidePopupMessage();
+				else if ((impl->isModifyEvent(event)) && (!impl->canModify(current)))
 					return true;
 			}
 			else if ((impl->isModifyEvent(event)) && (!impl->canModify(current)))
@@ -2736,14 +4005,20 @@ Application::eventFilter(QObject *obj, QEvent *event)
 		e->deleteResources();
 		return true;
 	}
+	else if (event->type() == sCallQueueEvent) {
+		sCallQueue.drain();
+		return true;
+	}
+	else if (event->type() == sCloseDCPaintersEvent) {
+		closeDCPainters();
+		return true;
+	}
 	
 	switch ((int)event->type()) {
 	
-	case QEvent::Timer:
+	case QEvent::ApplicationFontChange:
 		{
-			TimedCall *timedCall = qobject_cast<TimedCall *>(obj);
-			if (timedCall)
-				timedCall->executeAndDelete();
+			clearFontCache();
 		}
 		break;
 	
@@ -2756,7 +4031,7 @@ Application::eventFilter(QObject *obj, QEvent *event)
 				if ((area) && (area->viewport() != obj))
 					break;
 				EventRunner runner(obj, "onPaint");
-				if (runner.isValid()) {
+				if (runner.isHandled()) {
 					QPainter painter(w);
 					painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::NonCosmeticDefaultPen);
 	// 				painter.setPen(QPen(QColor(rand() % 256, rand() % 256, rand() % 256)));
@@ -3074,11 +4349,20 @@ Application::eventFilter(QObject *obj, QEvent *event)
 					}
 					break;
 				}
+				if (!runner.isHandled())
+					return false;
 				
 				runner.set("pos", QCursor::pos());
 				runner.set("buttons", (int)QApplication::mouseButtons());
 				runner.set("modifiers", getKeyModifiers(QApplication::keyboardModifiers()));
 				
+				if ((event->type() == QEvent::MouseMove) || (event->type() == QEvent::Wheel)) {
+					if (fCoalescer->post(obj, runner))
+						return false;
+				}
+				else {
+					fCoalescer->deliver(obj);
+				}
 				return !runner.run();
 			}
 		}
@@ -3277,21 +4561,8 @@ Application::eventFilter(QObject *obj, QEvent *event)
 		}
 		break;
 	
-	case QEvent::Shortcut:
-		{
-			if (sShortcutTestEvent.type() != QEvent::None) {
-				sShortcutTestEvent.accept();
-				hidePopupMessage();
-				return true;
-			}
-		}
-		break;
-
 	case QEvent::KeyPress:
 		{
-			if (event == &sShortcutTestEvent)
-				return true;
-
 			QWidget *w = qobject_cast<QWidget *>(obj);
 			if ((!w) || (w->focusProxy()))
 				return false;
@@ -3339,6 +4610,13 @@ Application::eventFilter(QObject *obj, QEvent *event)
 				else {
 					runner.setName("onKeyUp");
 				}
+				if ((!runner.isHandled()) && (sendCharEvent)) {
+					runner.setName("onChar");
+					sendCharEvent = false;
+				}
+				if (!runner.isHandled())
+					break;
+				
 				runner.set("modifiers", modifiers);
 				runner.set("code", getKeyCode(e->key()));
 				runner.set("char", text);
@@ -3349,7 +4627,8 @@ Application::eventFilter(QObject *obj, QEvent *event)
 				
 				if (sendCharEvent) {
 					runner.setName("onChar");
-					return !runner.run();
+					if (runner.isHandled())
+						return !runner.run();
 				}
 			}
 		}
@@ -3393,21 +4672,22 @@ Application::registerObject(QObject *object, Abstract_Proxy *proxy)
 {
 	QMutexLocker locker(fMutex);
 	object->moveToThread(thread());
-	QString name = QString("__slew_%1_%2").arg(object->metaObject()->className()).arg(fWID++);
-	object->setObjectName(name);
-	fWidgets[name] = (PyObject *)proxy;
+	ProxyData *data = (ProxyData *)object->userData(sProxyDataID);
+	if (data)
+		data->fProxy = proxy;
+	else
+		object->setUserData(sProxyDataID, new ProxyData(proxy));
 }
 
 
 void
 Application::unregisterObject(QObject *object)
 {
-	QString name = object->objectName();
 	QMutexLocker locker(fMutex);
-	Abstract_Proxy *proxy = (Abstract_Proxy *)fWidgets[name];
-	if (proxy) {
-		fWidgets.remove(name);
-		proxy->fImpl = NULL;
+	ProxyData *data = (ProxyData *)object->userData(sProxyDataID);
+	if ((data) && (data->fProxy)) {
+		data->fProxy->fImpl = NULL;
+		data->fProxy = NULL;
 	}
 }
 
@@ -3431,7 +4711,9 @@ Application::deallocProxy(Abstract_Proxy *proxy)
 	QObject *object = proxy->fImpl;
 	if (object) {
 		QMutexLocker locker(fMutex);
-		if (fWidgets.remove(object->objectName())) {
+		ProxyData *data = (ProxyData *)object->userData(sProxyDataID);
+		if ((data) && (data->fProxy == proxy)) {
+			data->fProxy = NULL;
 			proxy->fImpl = NULL;
 			object->deleteLater();
 		}
@@ -3445,7 +4727,9 @@ Application::replaceProxyObject(Abstract_Proxy *proxy, QObject *object)
 	QMutexLocker locker(fMutex);
 	QObject *oldObject = proxy->fImpl;
 	if (oldObject) {
-		fWidgets.remove(oldObject->objectName());
+		ProxyData *data = (ProxyData *)oldObject->userData(sProxyDataID);
+		if ((data) && (data->fProxy == proxy))
+			data->fProxy = NULL;
 	}
 	proxy->fImpl = object;
 	newProxy(proxy);
@@ -3456,8 +4740,9 @@ Application::replaceProxyObject(Abstract_Proxy *proxy, QObject *object)
 PyObject *
 Application::getProxy(QObject *object)
 {
-	QMutexLocker locker(fMutex);
-	return fWidgets[object->objectName()];
+	// lock free, the back pointer is only written while the object is being (un)registered
+	ProxyData *data = (ProxyData *)object->userData(sProxyDataID);
+	return data ? (PyObject *)data->fProxy : NULL;
 }
 
 
@@ -3519,6 +4804,7 @@ SL_DEFINE_MODULE_METHOD(run, {
 	
 	sIsRunning = true;
 	qApp->exec();
+	shutdownBackgroundTasks();
 	
 	Py_END_ALLOW_THREADS
 	Py_DECREF(sApplication);
@@ -3866,20 +5152,20 @@ SL_DEFINE_MODULE_METHOD(get_locale_info, {
 	PyDict_SetItemString(dict, "american_date", PyBool_FromLong(american ? 1 : 0));
 	
 	data = QString(locale.groupSeparator());
-	PyDict_SetItemString(dict, "thousands_sep", createStringObject(data));
-	PyDict_SetItemString(dict, "mon_thousands_sep", createStringObject(data));
+	PyDict_SetItemString(dict, "thousands_sep", createInternedStringObject(data));
+	PyDict_SetItemString(dict, "mon_thousands_sep", createInternedStringObject(data));
 	
 	data = QString(locale.decimalPoint());
-	PyDict_SetItemString(dict, "decimal_sep", createStringObject(data));
-	PyDict_SetItemString(dict, "mon_decimal_sep", createStringObject(data));
+	PyDict_SetItemString(dict, "decimal_sep", createInternedStringObject(data));
+	PyDict_SetItemString(dict, "mon_decimal_sep", createInternedStringObject(data));
 	
 	abbr = PyTuple_New(7);
 	full = PyTuple_New(7);
 	for (i = 1; i < 8; i++) {
 		data = locale.dayName(i, QLocale::ShortFormat);
-		PyTuple_SET_ITEM(abbr, i % 7, createStringObject(data));
+		PyTuple_SET_ITEM(abbr, i % 7, createInternedStringObject(data));
 		data = locale.dayName(i, QLocale::LongFormat);
-		PyTuple_SET_ITEM(full, i % 7, createStringObject(data));
+		PyTuple_SET_ITEM(full, i % 7, createInternedStringObject(data));
 	}
 	PyDict_SetItemString(dict, "wday", full);
 	PyDict_SetItemString(dict, "wday_short", abbr);
@@ -3888,9 +5174,9 @@ SL_DEFINE_MODULE_METHOD(get_locale_info, {
 	full = PyTuple_New(12);
 	for (i = 0; i < 12; i++) {
 		data = locale.monthName(i + 1, QLocale::ShortFormat);
-		PyTuple_SET_ITEM(abbr, i, createStringObject(data));
+		PyTuple_SET_ITEM(abbr, i, createInternedStringObject(data));
 		data = locale.monthName(i + 1, QLocale::LongFormat);
-		PyTuple_SET_ITEM(full, i, createStringObject(data));
+		PyTuple_SET_ITEM(full, i, createInternedStringObject(data));
 	}
 	PyDict_SetItemString(dict, "month", full);
 	PyDict_SetItemString(dict, "month_short", abbr);
@@ -4354,7 +5640,7 @@ SL_DEFINE_MODULE_METHOD(get_fonts_list, {
 	qSort(families);
 	
 	foreach (QString family, families) {
-		PyTuple_SET_ITEM(tuple, i++, createStringObject(family));
+		PyTuple_SET_ITEM(tuple, i++, createInternedStringObject(family));
 	}
 	return tuple;
 })
@@ -4471,7 +5757,7 @@ SL_DEFINE_MODULE_METHOD(normalize_format, {
 	}
 	
 	format = normalizeFormat(vars, format);
-	return createStringObject(format);
+	return createInternedStringObject(format);
 })
 
 
@@ -4661,9 +5947,243 @@ SL_DEFINE_MODULE_METHOD(call_later_timeout, {
 	}
 	PyObject *func_args = PyTuple_GetSlice(args, 2, size);
 	
-	setTimeout(NULL, timeout, func, func_args);
+	int id = setTimeout(NULL, timeout, func, func_args);
+	
+	Py_DECREF(func_args);
+	if (id)
+		return PyInt_FromLong(id);
+})
+
+
+SL_DEFINE_MODULE_METHOD(call_later_interval, {
+	Py_ssize_t size = PyTuple_Size(args);
+	if (PyErr_Occurred())
+		return NULL;
+	
+	if (size < 2) {
+		PyErr_SetString(PyExc_ValueError, "missing parameter(s)");
+		return NULL;
+	}
+	
+	int interval = PyInt_AsLong(PyTuple_GetItem(args, 0));
+	if (PyErr_Occurred())
+		return NULL;
+	if (interval <= 0) {
+		PyErr_SetString(PyExc_ValueError, "'interval' parameter must be positive");
+		return NULL;
+	}
+	
+	PyObject *func = PyTuple_GetItem(args, 1);
+	if (!PyCallable_Check(func)) {
+		PyErr_SetString(PyExc_ValueError, "'func' parameter must be a callable");
+		return NULL;
+	}
+	PyObject *func_args = PyTuple_GetSlice(args, 2, size);
+	
+	int id = setTimeout(NULL, interval, func, func_args, true);
 	
 	Py_DECREF(func_args);
+	return PyInt_FromLong(id);
+})
+
+
+SL_DEFINE_MODULE_METHOD(cancel_timer, {
+	static char *kwlist[] = { "id", NULL };
+	int id;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:cancel_timer", kwlist, &id))
+		return NULL;
+	
+	if (!qobject_cast<Application *>(qApp))
+		Py_RETURN_FALSE;
+	return createBoolObject(SL_QAPP()->timerWheel()->cancel(id));
+})
+
+
+SL_DEFINE_MODULE_METHOD(get_pending_timers, {
+	if (!qobject_cast<Application *>(qApp))
+		return PyInt_FromLong(0);
+	return PyInt_FromLong(SL_QAPP()->timerWheel()->pending());
+})
+
+
+SL_DEFINE_MODULE_METHOD(run_in_background, {
+	static char *kwlist[] = { "func", "args", "on_done", "on_error", "on_progress", NULL };
+	PyObject *func, *func_args = NULL, *on_done = NULL, *on_error = NULL, *on_progress = NULL;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OOOO:run_in_background", kwlist, &func, &func_args, &on_done, &on_error, &on_progress))
+		return NULL;
+	
+	if (!PyCallable_Check(func)) {
+		PyErr_SetString(PyExc_ValueError, "'func' parameter must be a callable");
+		return NULL;
+	}
+	if (func_args == Py_None)
+		func_args = NULL;
+	
+	return runInBackground(func, func_args, on_done, on_error, on_progress);
+})
+
+
+SL_DEFINE_MODULE_METHOD(get_current_task, {
+	return getCurrentTask();
+})
+
+
+SL_DEFINE_MODULE_METHOD(set_background_concurrency, {
+	static char *kwlist[] = { "count", NULL };
+	int count;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:set_background_concurrency", kwlist, &count))
+		return NULL;
+	
+	setBackgroundConcurrency(count);
+})
+
+
+SL_DEFINE_MODULE_METHOD(get_background_concurrency, {
+	return PyInt_FromLong(backgroundConcurrency());
+})
+
+
+SL_DEFINE_MODULE_METHOD(lookup_bitmap, {
+	static char *kwlist[] = { "name", "size", NULL };
+	QString name;
+	QSize size;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|O&:lookup_bitmap", kwlist, convertString, &name, convertSize, &size))
+		return NULL;
+	
+	QPixmap *pixmap = sImageCache.object(imageCacheKey(name, size));
+	if (!pixmap) {
+		sImageCacheMisses++;
+		Py_RETURN_NONE;
+	}
+	sImageCacheHits++;
+	return createBitmapObject(*pixmap);
+})
+
+
+SL_DEFINE_MODULE_METHOD(store_bitmap, {
+	static char *kwlist[] = { "name", "data", "size", NULL };
+	QString name;
+	QByteArray bytes;
+	QBuffer buffer;
+	QSize size;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&|O&:store_bitmap", kwlist, convertString, &name, convertBuffer, &bytes, convertSize, &size))
+		return NULL;
+	
+	// requested sizes are decoded straight at device resolution, never upscaled
+	qreal ratio = devicePixelRatio();
+	buffer.setData(bytes);
+	QImageReader reader(&buffer);
+	QSize imageSize = reader.size();
+	if ((!size.isEmpty()) && (imageSize.isValid())) {
+		QSize scaledSize = imageSize.scaled(size * ratio, Qt::KeepAspectRatio);
+		if ((scaledSize.width() < imageSize.width()) || (scaledSize.height() < imageSize.height()))
+			reader.setScaledSize(scaledSize);
+	}
+	QImage image = reader.read();
+	if (image.isNull()) {
+		PyErr_Format(PyExc_RuntimeError, "cannot load bitmap (%s)", (const char *)reader.errorString().toUtf8());
+		return NULL;
+	}
+	
+	QPixmap pixmap = QPixmap::fromImage(image);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 1, 0))
+	if (!size.isEmpty())
+		pixmap.setDevicePixelRatio(ratio);
+#endif
+	sImageCache.insert(imageCacheKey(name, size), new QPixmap(pixmap), qMax(1, (pixmap.width() * pixmap.height() * pixmap.depth()) / 8));
+	return createBitmapObject(pixmap);
+})
+
+
+SL_DEFINE_MODULE_METHOD(set_image_cache_limit, {
+	static char *kwlist[] = { "limit", NULL };
+	int limit;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:set_image_cache_limit", kwlist, &limit))
+		return NULL;
+	
+	sImageCache.setMaxCost(qMax(0, limit));
+})
+
+
+SL_DEFINE_MODULE_METHOD(clear_image_cache, {
+	sImageCache.clear();
+})
+
+
+SL_DEFINE_MODULE_METHOD(get_image_cache_stats, {
+	static char *kwlist[] = { "reset", NULL };
+	bool reset = false;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O&:get_image_cache_stats", kwlist, convertBool, &reset))
+		return NULL;
+	
+	PyObject *dict = PyDict_New();
+	if (!dict)
+		return NULL;
+	
+	PyObject *value;
+	
+	value = PyLong_FromUnsignedLongLong(sImageCacheHits);
+	PyDict_SetItemString(dict, "hits", value);
+	Py_XDECREF(value);
+	value = PyLong_FromUnsignedLongLong(sImageCacheMisses);
+	PyDict_SetItemString(dict, "misses", value);
+	Py_XDECREF(value);
+	value = PyInt_FromLong(sImageCache.count());
+	PyDict_SetItemString(dict, "count", value);
+	Py_XDECREF(value);
+	value = PyInt_FromLong(sImageCache.totalCost());
+	PyDict_SetItemString(dict, "bytes", value);
+	Py_XDECREF(value);
+	value = PyInt_FromLong(sImageCache.maxCost());
+	PyDict_SetItemString(dict, "limit", value);
+	Py_XDECREF(value);
+	
+	if (reset) {
+		sImageCacheHits = 0;
+		sImageCacheMisses = 0;
+	}
+	return dict;
+})
+
+
+SL_DEFINE_MODULE_METHOD(load_bitmap_async, {
+	static char *kwlist[] = { "data", "size", "callback", NULL };
+	PyObject *callback;
+	QByteArray data;
+	QSize size;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O:load_bitmap_async", kwlist, convertBuffer, &data, convertSize, &size, &callback))
+		return NULL;
+	
+	if (!PyCallable_Check(callback)) {
+		PyErr_SetString(PyExc_TypeError, "'callback' parameter must be a callable");
+		return NULL;
+	}
+	
+	return decodeInBackground(data, size, callback);
+})
+
+
+SL_DEFINE_MODULE_METHOD(set_decode_concurrency, {
+	static char *kwlist[] = { "count", NULL };
+	int count;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:set_decode_concurrency", kwlist, &count))
+		return NULL;
+	
+	setDecodeConcurrency(count);
+})
+
+
+SL_DEFINE_MODULE_METHOD(get_decode_concurrency, {
+	return PyInt_FromLong(decodeConcurrency());
 })
 
 
@@ -4700,6 +6220,65 @@ SL_DEFINE_MODULE_METHOD(set_keyboard_repeat_rate, {
 })
 
 
+SL_DEFINE_MODULE_METHOD(set_event_coalescing, {
+	static char *kwlist[] = { "interval", NULL };
+	int interval;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:set_event_coalescing", kwlist, &interval))
+		return NULL;
+	
+	if (qobject_cast<Application *>(qApp))
+		SL_QAPP()->coalescer()->setInterval(interval);
+})
+
+
+SL_DEFINE_MODULE_METHOD(get_event_coalescing_stats, {
+	static char *kwlist[] = { "reset", NULL };
+	bool reset = false;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O&:get_event_coalescing_stats", kwlist, convertBool, &reset))
+		return NULL;
+	
+	if (!qobject_cast<Application *>(qApp))
+		return PyDict_New();
+	return SL_QAPP()->coalescer()->getStats(reset);
+})
+
+
+SL_DEFINE_MODULE_METHOD(set_call_queue_budget, {
+	static char *kwlist[] = { "msecs", NULL };
+	int msecs;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "i:set_call_queue_budget", kwlist, &msecs))
+		return NULL;
+	
+	sCallQueue.setBudget(msecs);
+})
+
+
+SL_DEFINE_MODULE_METHOD(get_call_queue_stats, {
+	static char *kwlist[] = { "reset", NULL };
+	bool reset = false;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O&:get_call_queue_stats", kwlist, convertBool, &reset))
+		return NULL;
+	
+	return sCallQueue.getStats(reset);
+})
+
+
+SL_DEFINE_MODULE_METHOD(benchmark_pixel_kernels, {
+	static char *kwlist[] = { "size", "iterations", NULL };
+	QSize size;
+	int iterations = 10;
+	
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|i:benchmark_pixel_kernels", kwlist, convertSize, &size, &iterations))
+		return NULL;
+	
+	return benchmarkPixelKernels(size, iterations);
+})
+
+
 SL_DEFINE_MODULE_METHOD(get_standard_bitmap, {
 	static char *kwlist[] = { "bitmap", "size", NULL };
 	int type;
@@ -4816,6 +6395,23 @@ SL_DEFINE_MODULE_METHOD(find_focus, {
 })
 
 
+SL_DEFINE_MODULE_METHOD(reset_handlers, {
+	PyObject *object;
+	
+	if (!PyArg_ParseTuple(args, "O", &object))
+		return NULL;
+	
+	Abstract_Proxy *proxy = getProxy(object);
+	if (!proxy)
+		return NULL;
+	if ((PyObject_TypeCheck(proxy, &Widget_Type)) || (PyObject_TypeCheck(proxy, &SceneItem_Type))) {
+		Widget_Proxy *widgetProxy = (Widget_Proxy *)proxy;
+		if (widgetProxy->fHandlers)
+			widgetProxy->fHandlers->reset();
+	}
+})
+
+
 SL_DEFINE_MODULE_METHOD(beep, {
 	QApplication::beep();
 })
@@ -4828,14 +6424,17 @@ SL_DEFINE_MODULE_METHOD(get_backend_info, {
 
 SL_DEFINE_MODULE_METHOD(get_font_text_extent, {
 	static char *kwlist[] = { "font", "text", "max_width", NULL };
-	QFont font;
+	PyObject *font;
 	QString text;
 	double maxWidth;
 	
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&d:get_font_text_extent", kwlist, convertFont, &font, convertString, &text, &maxWidth))
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO&d:get_font_text_extent", kwlist, &font, convertString, &text, &maxWidth))
 		return NULL;
 	
-	return createVectorObject(getTextExtent(QFontMetricsF(font), text, maxWidth));
+	QFontMetricsF metrics = getFontMetrics(font);
+	if (PyErr_Occurred())
+		return NULL;
+	return createVectorObject(getTextExtent(metrics, text, maxWidth));
 })
 
 
@@ -4897,15 +6496,36 @@ SL_METHOD(has_clipboard_data)
 SL_METHOD(set_clipboard_data)
 SL_METHOD(add_clipboard_data)
 SL_METHOD(call_later_timeout)
+SL_METHOD(call_later_interval)
+SL_METHOD(cancel_timer)
+SL_METHOD(get_pending_timers)
+SL_METHOD(run_in_background)
+SL_METHOD(get_current_task)
+SL_METHOD(set_background_concurrency)
+SL_METHOD(get_background_concurrency)
+SL_METHOD(lookup_bitmap)
+SL_METHOD(store_bitmap)
+SL_METHOD(set_image_cache_limit)
+SL_METHOD(clear_image_cache)
+SL_METHOD(get_image_cache_stats)
+SL_METHOD(load_bitmap_async)
+SL_METHOD(set_decode_concurrency)
+SL_METHOD(get_decode_concurrency)
 SL_METHOD(get_mouse_buttons)
 SL_METHOD(get_mouse_pos)
 SL_METHOD(get_keyboard_modifiers)
 SL_METHOD(get_keyboard_repeat_rate)
 SL_METHOD(set_keyboard_repeat_rate)
+SL_METHOD(set_event_coalescing)
+SL_METHOD(get_event_coalescing_stats)
+SL_METHOD(set_call_queue_budget)
+SL_METHOD(get_call_queue_stats)
+SL_METHOD(benchmark_pixel_kernels)
 SL_METHOD(get_standard_bitmap)
 SL_METHOD(get_screen_dpi)
 SL_METHOD(get_screen_bitmap)
 SL_METHOD(find_focus)
+SL_METHOD(reset_handlers)
 SL_METHOD(beep)
 SL_METHOD(get_backend_info)
 SL_METHOD(get_font_text_extent)
@@ -4997,6 +6617,8 @@ init_slew()
 		(!Bitmap_type_setup(module)) ||
 		(!Picture_type_setup(module)) ||
 		(!DataModel_type_setup(module)) ||
+		(!Event_type_setup(module)) ||
+		(!Task_type_setup(module)) ||
 		(!SceneItem_type_setup(module)) ||
 		(!WebView_type_setup(module)) ||
 		
@@ -5007,10 +6629,21 @@ init_slew()
 	if (module) {
 		dict = PyModule_GetDict(module);
 		PyEvent_Type = PyDict_GetItemString(dict, "Event");
+		PyEventHandler_Type = PyDict_GetItemString(dict, "EventHandler");
+		inheritEventConstants(PyEvent_Type);
 		PyPaper_Type = PyDict_GetItemString(dict, "Paper");
 		sVectorType = PyDict_GetItemString(dict, "Vector");
 		sColorType = PyDict_GetItemString(dict, "Color");
 		sFontType = PyDict_GetItemString(dict, "Font");
+		{
+			static const char *vectorSlots[] = { "x", "y" };
+			static const char *colorSlots[] = { "r", "g", "b", "a" };
+			static const char *fontSlots[] = { "family", "face", "size", "style", "spacing" };
+			
+			lookupSlots(sVectorType, vectorSlots, sVectorSlots, 2);
+			lookupSlots(sColorType, colorSlots, sColorSlots, 4);
+			lookupSlots(sFontType, fontSlots, sFontSlots, 5);
+		}
 		PyDC_Type = PyDict_GetItemString(dict, "DC");
 		PyPrintDC_Type = PyDict_GetItemString(dict, "PrintDC");
 		sBitmapType = PyDict_GetItemString(dict, "Bitmap");
@@ -33,8 +33,12 @@
 #include <QByteArray>
 #include <QDate>
 #include <QDateTime>
+#include <QVariant>
 #include <QThread>
 #include <QMutex>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
 
 class QWidget;
 class QAbstractButton;
@@ -101,7 +105,6 @@ class Widget_Impl;
 class Sizer_Impl;
 class DataModel_Impl;
 class Completer;
-class TimedCall;
 
 
 int convertBuffer(PyObject *object, QByteArray *value);
@@ -148,10 +151,12 @@ PyObject *createVectorObject(const QSizeF& size);
 PyObject *createBoolObject(bool boolean);
 PyObject *createIntListObject(const QList<int>& list);
 PyObject *createStringObject(const QString& string);
+PyObject *createInternedStringObject(const QString& string);
 PyObject *createColorObject(const QColor& color);
 PyObject *createFontObject(const QFont& font, bool system=false);
 PyObject *createDCObject(QPainter *painter, PyObject *objectType=NULL, PyObject *proxyType=NULL, QPaintDevice *device=NULL, QTransform *baseTransform=NULL);
 PyObject *createBitmapObject(const QPixmap& pixmap);
+PyObject *createBitmapObject(const QImage& image);
 PyObject *createPictureObject(const QPicture& picture);
 PyObject *createIconObject(const QIcon& icon);
 PyObject *createDateObject(const QDate& date);
@@ -170,7 +175,10 @@ QObject *getImpl(PyObject *object);
 QString normalizeFormat(const QHash<QString, QString>& vars, const QString& format);
 void centerWindow(QWidget *window, QWidget *parent = NULL);
 void setShortcut(QWidget *widget, const QString& sequence, Qt::ShortcutContext context, PyObject *callback);
-void setTimeout(QObject *parent, int delay, PyObject *func, PyObject *args);
+void registerShortcut(QObject *owner, const QKeySequence& key);
+void unregisterShortcut(QObject *owner);
+bool isShortcutBound(QKeyEvent *event, QWidget *focus);
+int setTimeout(QObject *parent, int delay, PyObject *func, PyObject *args, bool periodic = false);
 bool loadResource(const QString& resource, QByteArray& data);
 bool openURI(const QString& uri);
 
@@ -210,8 +218,15 @@ bool printSetup(PyObject *settings, PyObject *parent, bool *accepted);
 PyObject *printDocument(int type, const QString& title, PyObject *callback, bool prompt, PyObject *settings, PyObject *parent, QObject *handler = NULL);
 
 void freeBitmapResources(QPainter *painter, QPaintDevice *device);
+void scheduleCloseDCPainters();
+QPainter *getDCPainter(DC_Proxy *self);
+void endDCPainter(DC_Proxy *self);
+void closeDCPainters();
+void freeDCResources(DC_Proxy *self);
 
 QSizeF getTextExtent(const QFontMetricsF& fm, const QString& text, double max_width);
+QFontMetricsF getFontMetrics(PyObject *font);
+void clearFontCache();
 
 
 #ifdef Q_OS_MAC
@@ -309,37 +324,66 @@ private:
 
 
 
+typedef QHash<QByteArray, QVariant> EventFields;
+
+
+
+class HandlerCache
+{
+public:
+	HandlerCache() : fHandler(NULL), fType(NULL), fVersion(0) {}
+	~HandlerCache() { reset(); }
+	
+	void reset();
+	PyObject *getHandler(PyObject *widget);
+	PyObject *getMethod(PyObject *handler, const QByteArray& name, bool *overridden);
+	
+private:
+	struct Entry {
+		PyObject					*fFunc;
+		bool						fOverridden;
+	};
+	
+	PyObject						*fHandler;
+	PyTypeObject					*fType;
+	unsigned int					fVersion;
+	QHash<QByteArray, Entry>		fMethods;
+};
+
+
+
 class EventRunner
 {
 public:
 	EventRunner(Widget_Proxy *proxy, const QString& name = "")
-		: fProxy(proxy), fName(name), fEvent(NULL), fParams(NULL) { if (fLocker.isValid()) { Py_XINCREF(proxy); fParams = PyDict_New(); } }
+		: fProxy(proxy), fName(name), fEvent(NULL), fParams(NULL), fHandler(NULL), fMethod(NULL), fResolved(false), fOverridden(false) { if (fLocker.isValid()) { Py_XINCREF(proxy); fParams = PyDict_New(); } }
 	EventRunner(QObject *object, const QString& name = "")
-		: fProxy(NULL), fName(name), fEvent(NULL), fParams(NULL) { if (fLocker.isValid()) { fProxy = getSafeProxy(object); Py_XINCREF(fProxy); fParams = PyDict_New(); } }
-	~EventRunner() { Py_XDECREF(fParams); Py_XDECREF(fEvent); Py_XDECREF(fProxy); }
+		: fProxy(NULL), fName(name), fEvent(NULL), fParams(NULL), fHandler(NULL), fMethod(NULL), fResolved(false), fOverridden(false) { if (fLocker.isValid()) { fProxy = getSafeProxy(object); Py_XINCREF(fProxy); fParams = PyDict_New(); } }
+	~EventRunner() { release(); Py_XDECREF(fParams); Py_XDECREF(fEvent); Py_XDECREF(fProxy); }
 	
-	void setName(const QString& name) { fName = name; }
+	void setName(const QString& name) { if (name != fName) release(); fName = name; }
 	QString name() { return fName; }
 	
 	QWidget *widget() { return fProxy ? (QWidget *)fProxy->fImpl : NULL; }
 	bool isValid() { return (fLocker.isValid()) && (fProxy != NULL); }
-	
-	void set(const char *param, PyObject *value, bool decref=true) { PyDict_SetItemString(fParams, param, value); if (decref) Py_DECREF(value); }
-	void set(const char *param, bool value) { set(param, createBoolObject(value)); }
-	void set(const char *param, int value) { set(param, PyInt_FromLong(value)); }
-	void set(const char *param, double value) { set(param, PyFloat_FromDouble(value)); }
-	void set(const char *param, const QString& value) { set(param, createStringObject(value)); }
-	void set(const char *param, const QPoint& value) { set(param, createVectorObject(value)); }
-	void set(const char *param, const QPointF& value) { set(param, createVectorObject(value)); }
-	void set(const char *param, const QSize& value) { set(param, createVectorObject(value)); }
-	void set(const char *param, const QSizeF& value) { set(param, createVectorObject(value)); }
-	void set(const char *param, const QColor& value) { set(param, createColorObject(value)); }
-	void set(const char *param, const QFont& value) { set(param, createFontObject(value)); }
-	void set(const char *param, const QByteArray& value) { set(param, createBufferObject(value)); }
-	void set(const char *param, const QDate& value) { set(param, createDateObject(value)); }
-	void set(const char *param, const QDateTime& value) { set(param, createDateTimeObject(value)); }
-	void set(const char *param, const QPixmap& value) { set(param, createBitmapObject(value)); }
-	void set(const char *param, const QIcon& value) { set(param, createIconObject(value)); }
+	bool isHandled() { return (resolve()) && (fOverridden); }
+	
+	void set(const char *param, PyObject *value, bool decref=true) { fFields.remove(param); PyDict_SetItemString(fParams, param, value); if (decref) Py_DECREF(value); }
+	void set(const char *param, bool value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, int value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, double value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QString& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QPoint& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QPointF& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QSize& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QSizeF& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QColor& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QFont& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QByteArray& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QDate& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QDateTime& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QPixmap& value) { setField(param, QVariant::fromValue(value)); }
+	void set(const char *param, const QIcon& value) { setField(param, QVariant::fromValue(value)); }
 	
 	bool get(const char *param, PyObject **value) { if (!fEvent) return false; PyObject *o = PyObject_GetAttrString(fEvent, param); if (o) { Py_DECREF(o); *value = o; return true; } PyErr_Clear(); return false; }
 	bool get(const char *param, bool *value) { return fEvent ? getObjectAttr(fEvent, param, value) : false; }
@@ -356,14 +400,127 @@ public:
 	bool get(const char *param, QPixmap *value) { return fEvent ? getObjectAttr(fEvent, param, value) : false; }
 	bool get(const char *param, QIcon *value) { return fEvent ? getObjectAttr(fEvent, param, value) : false; }
 	
+	PyObject *params() { return fParams; }
+	const EventFields& fields() { return fFields; }
+	void assign(PyObject *params, const EventFields& fields) { PyDict_Update(fParams, params); fFields = fields; }
+	
 	bool run();
 	
 private:
+	bool resolve();
+	void release() { Py_CLEAR(fMethod); Py_CLEAR(fHandler); fResolved = false; fOverridden = false; }
+	void setField(const char *param, const QVariant& value) { if ((fParams) && (PyDict_GetItemString(fParams, param))) PyDict_DelItemString(fParams, param); fFields.insert(param, value); }
+	
 	PyAutoLocker					fLocker;
 	Widget_Proxy					*fProxy;
 	QString							fName;
 	PyObject						*fEvent;
 	PyObject						*fParams;
+	EventFields						fFields;
+	PyObject						*fHandler;
+	PyObject						*fMethod;
+	bool							fResolved;
+	bool							fOverridden;
+};
+
+
+
+class EventCoalescer : public QObject
+{
+	Q_OBJECT
+	
+public:
+	EventCoalescer(QObject *parent = NULL);
+	virtual ~EventCoalescer();
+	
+	int interval() { return fInterval; }
+	void setInterval(int interval);
+	
+	bool post(QObject *target, EventRunner& runner);
+	void deliver(QObject *target = NULL);
+	
+	PyObject *getStats(bool reset);
+	
+private slots:
+	void handleTimeout();
+	
+private:
+	struct Pending {
+		QPointer<QObject>			fTarget;
+		QString						fName;
+		PyObject					*fParams;
+		EventFields					fFields;
+	};
+	
+	int								fInterval;
+	QTimer							*fTimer;
+	QElapsedTimer					fLastDelivery;
+	QList<Pending *>				fPending;
+	QHash<QString, qulonglong>		fDelivered;
+	QHash<QString, qulonglong>		fDropped;
+};
+
+
+
+class TimerWheel : public QObject
+{
+	Q_OBJECT
+	
+public:
+	TimerWheel(QObject *parent = NULL);
+	virtual ~TimerWheel();
+	
+	int add(QObject *owner, int delay, PyObject *func, PyObject *args, bool periodic);
+	bool cancel(int id);
+	void cancelOwner(QObject *owner);
+	int pending();
+	
+private slots:
+	void reschedule();
+	void handleTimeout();
+	void handleOwnerDestroyed(QObject *owner);
+	
+private:
+	enum {
+		kTick = 10,
+		kBits = 6,
+		kSize = 1 << kBits,
+		kMask = kSize - 1,
+		kLevels = 5,
+	};
+	
+	struct Entry {
+		Entry						*fNext;
+		Entry						**fPrev;
+		int							fID;
+		quint64						fExpires;
+		int							fInterval;
+		bool						fCancelled;
+		QObject						*fOwner;
+		QPointer<QObject>			fGuard;
+		PyObject					*fFunc;
+		PyObject					*fArgs;
+	};
+	
+	static bool lessThan(const Entry *a, const Entry *b) { return a->fID < b->fID; }
+	
+	quint64 now() { return (quint64)fClock.elapsed() / kTick; }
+	qint64 nextWake();
+	void link(Entry *entry);
+	void unlink(Entry *entry);
+	Entry *detach(Entry *entry);
+	void release(Entry *entry);
+	void advance(quint64 tick, QList<Entry *>& expired);
+	void fire(Entry *entry);
+	
+	QMutex							fMutex;
+	QTimer							*fTimer;
+	QElapsedTimer					fClock;
+	quint64							fCurrent;
+	int								fLastID;
+	Entry							*fSlots[kLevels][kSize];
+	QHash<int, Entry *>				fTimers;
+	QHash<QObject *, Entry *>		fOwned;
 };
 
 
@@ -406,6 +563,8 @@ public:
 	virtual ~Application();
 	
 	QMainWindow *shadowWindow() { return fShadowWindow; }
+	EventCoalescer *coalescer() { return fCoalescer; }
+	TimerWheel *timerWheel() { return fTimerWheel; }
 	
 	void lock() { fMutex->lock(); }
 	void unlock() { fMutex->unlock(); }
@@ -435,9 +594,9 @@ public slots:
 
 private:
 	QMainWindow						*fShadowWindow;
+	EventCoalescer					*fCoalescer;
+	TimerWheel						*fTimerWheel;
 	QMutex							*fMutex;
-	QHash<QString, PyObject *>		fWidgets;
-	qulonglong						fWID;
 };
 
 
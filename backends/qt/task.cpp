@@ -0,0 +1,495 @@
+#include "slew.h"
+
+#include "objects.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QBuffer>
+#include <QImageReader>
+
+
+enum {
+	kPending,
+	kRunning,
+	kFinished,
+};
+
+
+typedef struct Task_Proxy {
+	PyObject_HEAD
+	PyObject					*fFunc;
+	PyObject					*fArgs;
+	PyObject					*fOnDone;
+	PyObject					*fOnError;
+	PyObject					*fOnProgress;
+	int							fState;
+	bool						fCancelled;
+} Task_Proxy;
+
+
+static QThreadPool *sPool = NULL;
+static QThreadPool *sDecodePool = NULL;
+static QAtomicInt sShuttingDown;
+
+
+static QThreadPool *
+getPool()
+{
+	if (!sPool)
+		sPool = new QThreadPool;
+	return sPool;
+}
+
+
+static QThreadPool *
+getDecodePool()
+{
+	// image decoding is memory hungry, so it gets its own smaller pool
+	if (!sDecodePool) {
+		sDecodePool = new QThreadPool;
+		sDecodePool->setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+	}
+	return sDecodePool;
+}
+
+
+static bool
+isCancelled(Task_Proxy *self)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+	return (self->fCancelled) || (sShuttingDown.load() != 0);
+#else
+	return (self->fCancelled) || (int(sShuttingDown) != 0);
+#endif
+}
+
+
+static PyObject *
+Task_deliver(Task_Proxy *self, PyObject *args)
+{
+	PyObject *handler, *handlerArgs;
+	
+	if (!PyArg_ParseTuple(args, "OO", &handler, &handlerArgs))
+		return NULL;
+	
+	if (!self->fCancelled) {
+		PyObject *result = PyObject_CallObject(handler, handlerArgs);
+		if (!result)
+			return NULL;
+		Py_DECREF(result);
+	}
+	Py_RETURN_NONE;
+}
+
+
+static PyMethodDef sDeliverDef = { "deliver", (PyCFunction)Task_deliver, METH_VARARGS, NULL };
+
+
+static void
+post(Task_Proxy *self, PyObject *handler, PyObject *handlerArgs)
+{
+	// handlers are run on the main thread through the call_later queue
+	PyObject *deliver = PyCFunction_New(&sDeliverDef, (PyObject *)self);
+	PyObject *args = PyTuple_Pack(2, handler, handlerArgs);
+	
+	if ((deliver) && (args)) {
+		setTimeout(NULL, 0, deliver, args);
+	}
+	else {
+		PyErr_Print();
+		PyErr_Clear();
+	}
+	Py_XDECREF(deliver);
+	Py_XDECREF(args);
+}
+
+
+
+static void
+destroyImage(PyObject *capsule)
+{
+	delete (QImage *)PyCapsule_GetPointer(capsule, NULL);
+}
+
+
+static PyObject *
+Task_decoded(PyObject *self, PyObject *args)
+{
+	PyObject *callback, *capsule;
+	
+	if (!PyArg_ParseTuple(args, "OO", &callback, &capsule))
+		return NULL;
+	
+	QImage *image = (QImage *)PyCapsule_GetPointer(capsule, NULL);
+	if (!image)
+		return NULL;
+	
+	PyObject *bitmap = createBitmapObject(*image);
+	if (!bitmap)
+		return NULL;
+	
+	PyObject *result = PyObject_CallFunctionObjArgs(callback, bitmap, NULL);
+	Py_DECREF(bitmap);
+	if (!result)
+		return NULL;
+	Py_DECREF(result);
+	Py_RETURN_NONE;
+}
+
+
+static PyMethodDef sDecodedDef = { "decoded", (PyCFunction)Task_decoded, METH_VARARGS, NULL };
+
+
+
+class BackgroundTask : public QRunnable
+{
+public:
+	BackgroundTask(Task_Proxy *task) : QRunnable(), fTask(task) { Py_INCREF(task); }
+	
+	virtual void run()
+	{
+		PyAutoLocker locker;
+		if (!locker.isValid())
+			return;
+		
+		if (!isCancelled(fTask)) {
+			PyObject *dict = PyThreadState_GetDict();
+			PyObject *type = NULL, *value = NULL, *traceback = NULL;
+			
+			fTask->fState = kRunning;
+			if (dict)
+				PyDict_SetItemString(dict, "slew.task", (PyObject *)fTask);
+			
+			PyObject *result = PyObject_CallObject(fTask->fFunc, fTask->fArgs);
+			if (!result) {
+				if (!PyErr_Occurred())
+					PyErr_SetString(PyExc_SystemError, "error return without exception set");
+				PyErr_Fetch(&type, &value, &traceback);
+				PyErr_NormalizeException(&type, &value, &traceback);
+			}
+			
+			if ((dict) && (PyDict_DelItemString(dict, "slew.task") < 0))
+				PyErr_Clear();
+			
+			if (result) {
+				if (fTask->fOnDone) {
+					PyObject *args = PyTuple_Pack(1, result);
+					post(fTask, fTask->fOnDone, args);
+					Py_XDECREF(args);
+				}
+				Py_DECREF(result);
+			}
+			else if (fTask->fOnError) {
+				PyObject *args = PyTuple_Pack(3, type, value ? value : Py_None, traceback ? traceback : Py_None);
+				post(fTask, fTask->fOnError, args);
+				Py_XDECREF(args);
+				Py_XDECREF(type);
+				Py_XDECREF(value);
+				Py_XDECREF(traceback);
+			}
+			else {
+				PyErr_Restore(type, value, traceback);
+				PyErr_Print();
+				PyErr_Clear();
+			}
+		}
+		fTask->fState = kFinished;
+		Py_DECREF(fTask);
+	}
+
+private:
+	Task_Proxy		*fTask;
+};
+
+
+
+class DecodeTask : public QRunnable
+{
+public:
+	DecodeTask(Task_Proxy *task, const QByteArray& data, const QSize& size) : QRunnable(), fTask(task), fData(data), fSize(size) { Py_INCREF(task); }
+	
+	virtual void run()
+	{
+		QImage *image = NULL;
+		
+		// decoding runs without the GIL, the bitmap is only created on the main thread
+		if (!isCancelled(fTask)) {
+			fTask->fState = kRunning;
+			QBuffer buffer(&fData);
+			QImageReader reader(&buffer);
+			QSize size = reader.size();
+			if ((!fSize.isEmpty()) && (size.isValid()) && ((size.width() > fSize.width()) || (size.height() > fSize.height())))
+				reader.setScaledSize(size.scaled(fSize, Qt::KeepAspectRatio));
+			image = new QImage(reader.read());
+		}
+		
+		PyAutoLocker locker;
+		if (!locker.isValid()) {
+			delete image;
+			return;
+		}
+		
+		if ((image) && (!isCancelled(fTask))) {
+			PyObject *capsule = PyCapsule_New(image, NULL, destroyImage);
+			PyObject *decoded = PyCFunction_New(&sDecodedDef, NULL);
+			PyObject *args = NULL;
+			if (capsule) {
+				image = NULL;
+				args = PyTuple_Pack(2, fTask->fOnDone, capsule);
+			}
+			if ((decoded) && (args)) {
+				post(fTask, decoded, args);
+			}
+			else {
+				PyErr_Print();
+				PyErr_Clear();
+			}
+			Py_XDECREF(capsule);
+			Py_XDECREF(decoded);
+			Py_XDECREF(args);
+		}
+		delete image;
+		fTask->fState = kFinished;
+		Py_DECREF(fTask);
+	}
+
+private:
+	Task_Proxy		*fTask;
+	QByteArray		fData;
+	QSize			fSize;
+};
+
+
+
+static int
+Task_traverse(Task_Proxy *self, visitproc visit, void *arg)
+{
+	Py_VISIT(self->fFunc);
+	Py_VISIT(self->fArgs);
+	Py_VISIT(self->fOnDone);
+	Py_VISIT(self->fOnError);
+	Py_VISIT(self->fOnProgress);
+	return 0;
+}
+
+
+static int
+Task_clear(Task_Proxy *self)
+{
+	Py_CLEAR(self->fFunc);
+	Py_CLEAR(self->fArgs);
+	Py_CLEAR(self->fOnDone);
+	Py_CLEAR(self->fOnError);
+	Py_CLEAR(self->fOnProgress);
+	return 0;
+}
+
+
+static void
+Task_dealloc(Task_Proxy *self)
+{
+	PyObject_GC_UnTrack(self);
+	Task_clear(self);
+	self->ob_type->tp_free((PyObject*)self);
+}
+
+
+static PyObject *
+Task_cancel(Task_Proxy *self, PyObject *args)
+{
+	self->fCancelled = true;
+	return createBoolObject(self->fState != kFinished);
+}
+
+
+static PyObject *
+Task_is_cancelled(Task_Proxy *self, PyObject *args)
+{
+	return createBoolObject(isCancelled(self));
+}
+
+
+static PyObject *
+Task_is_running(Task_Proxy *self, PyObject *args)
+{
+	return createBoolObject(self->fState == kRunning);
+}
+
+
+static PyObject *
+Task_is_finished(Task_Proxy *self, PyObject *args)
+{
+	return createBoolObject(self->fState == kFinished);
+}
+
+
+static PyObject *
+Task_report_progress(Task_Proxy *self, PyObject *args)
+{
+	if ((self->fOnProgress) && (!isCancelled(self)))
+		post(self, self->fOnProgress, args);
+	Py_RETURN_NONE;
+}
+
+
+static PyMethodDef Task_methods[] = {
+	{	"cancel", (PyCFunction)Task_cancel, METH_NOARGS, NULL },
+	{	"is_cancelled", (PyCFunction)Task_is_cancelled, METH_NOARGS, NULL },
+	{	"is_running", (PyCFunction)Task_is_running, METH_NOARGS, NULL },
+	{	"is_finished", (PyCFunction)Task_is_finished, METH_NOARGS, NULL },
+	{	"report_progress", (PyCFunction)Task_report_progress, METH_VARARGS, NULL },
+	{	NULL, NULL, 0, NULL }
+};
+
+
+PyTypeObject Task_Type =
+{
+	PyObject_HEAD_INIT(NULL)
+	0,											/* ob_size */
+	"slew._slew.BackgroundTask",				/* tp_name */
+	sizeof(Task_Proxy),							/* tp_basicsize */
+	0,											/* tp_itemsize */
+	(destructor)Task_dealloc,					/* tp_dealloc */
+	0,											/* tp_print */
+	0,											/* tp_getattr */
+	0,											/* tp_setattr */
+	0,											/* tp_compare */
+	0,											/* tp_repr */
+	0,											/* tp_as_number */
+	0,											/* tp_as_sequence */
+	0,											/* tp_as_mapping */
+	0,											/* tp_hash */
+	0,											/* tp_call */
+	0,											/* tp_str */
+	0,											/* tp_getattro */
+	0,											/* tp_setattro */
+	0,											/* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,	/* tp_flags */
+	"BackgroundTask objects",					/* tp_doc */
+	(traverseproc)Task_traverse,				/* tp_traverse */
+	(inquiry)Task_clear,						/* tp_clear */
+	0,											/* tp_richcompare */
+	0,											/* tp_weaklistoffset */
+	0,											/* tp_iter */
+	0,											/* tp_iternext */
+	Task_methods,								/* tp_methods */
+};
+
+
+PyObject *
+runInBackground(PyObject *func, PyObject *args, PyObject *onDone, PyObject *onError, PyObject *onProgress)
+{
+	Task_Proxy *self = (Task_Proxy *)Task_Type.tp_alloc(&Task_Type, 0);
+	if (!self)
+		return NULL;
+	
+	self->fArgs = args ? PySequence_Tuple(args) : PyTuple_New(0);
+	if (!self->fArgs) {
+		Py_DECREF(self);
+		return NULL;
+	}
+	
+	Py_INCREF(func);
+	self->fFunc = func;
+	if ((onDone) && (onDone != Py_None)) {
+		Py_INCREF(onDone);
+		self->fOnDone = onDone;
+	}
+	if ((onError) && (onError != Py_None)) {
+		Py_INCREF(onError);
+		self->fOnError = onError;
+	}
+	if ((onProgress) && (onProgress != Py_None)) {
+		Py_INCREF(onProgress);
+		self->fOnProgress = onProgress;
+	}
+	self->fState = kPending;
+	self->fCancelled = false;
+	
+	getPool()->start(new BackgroundTask(self));
+	
+	return (PyObject *)self;
+}
+
+
+PyObject *
+decodeInBackground(const QByteArray& data, const QSize& size, PyObject *callback)
+{
+	Task_Proxy *self = (Task_Proxy *)Task_Type.tp_alloc(&Task_Type, 0);
+	if (!self)
+		return NULL;
+	
+	Py_INCREF(callback);
+	self->fOnDone = callback;
+	self->fState = kPending;
+	self->fCancelled = false;
+	
+	getDecodePool()->start(new DecodeTask(self, data, size));
+	
+	return (PyObject *)self;
+}
+
+
+PyObject *
+getCurrentTask()
+{
+	PyObject *dict = PyThreadState_GetDict();
+	PyObject *task = dict ? PyDict_GetItemString(dict, "slew.task") : NULL;
+	
+	if (!task)
+		task = Py_None;
+	Py_INCREF(task);
+	return task;
+}
+
+
+void
+setBackgroundConcurrency(int count)
+{
+	getPool()->setMaxThreadCount(qMax(1, count));
+}
+
+
+int
+backgroundConcurrency()
+{
+	return getPool()->maxThreadCount();
+}
+
+
+void
+setDecodeConcurrency(int count)
+{
+	getDecodePool()->setMaxThreadCount(qMax(1, count));
+}
+
+
+int
+decodeConcurrency()
+{
+	return getDecodePool()->maxThreadCount();
+}
+
+
+void
+shutdownBackgroundTasks()
+{
+	// must be called with the GIL released, running tasks are asked to stop and waited for
+	sShuttingDown.fetchAndStoreOrdered(1);
+	if (sPool)
+		sPool->waitForDone();
+	if (sDecodePool)
+		sDecodePool->waitForDone();
+}
+
+
+bool
+Task_type_setup(PyObject *module)
+{
+	if (PyType_Ready(&Task_Type) < 0)
+		return false;
+	Py_INCREF(&Task_Type);
+	PyModule_AddObject(module, "BackgroundTask", (PyObject *)&Task_Type);
+	return true;
+}
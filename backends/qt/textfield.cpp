@@ -430,7 +430,7 @@ SL_DEFINE_METHOD(TextField, set_filter, {
 
 
 SL_DEFINE_METHOD(TextField, get_format, {
-	return createStringObject(impl->format());
+	return createInternedStringObject(impl->format());
 })
 
 
@@ -300,6 +300,7 @@ SL_DEFINE_METHOD(ToolBarItem, set_text, {
 		int pos = text.indexOf('|');
 		if ((pos != -1) && (pos + 1 < text.length())) {
 			impl->setShortcut(QKeySequence(text.mid(pos + 1)));
+			registerShortcut(impl, impl->shortcut());
 			text = text.mid(0, pos);
 		}
 		impl->setText(text);
@@ -7,6 +7,8 @@
 #include <QMouseEvent>
 #include <QToolTip>
 #include <QCommonStyle>
+#include <QScrollBar>
+#include <QSet>
 
 
 
@@ -88,7 +90,7 @@ private:
 
 
 TreeView_Impl::TreeView_Impl()
-	: QTreeView(), WidgetInterface(), fShowExpanders(true), fShowRules(false), fExpandState(Waiting)
+	: QTreeView(), WidgetInterface(), fShowExpanders(true), fShowRules(false), fExpandState(Waiting), fBatchExpanding(false)
 {
 	setHorizontalScrollMode(ScrollPerPixel);
 	setVerticalScrollMode(ScrollPerPixel);
@@ -448,6 +450,10 @@ TreeView_Impl::handleSelectionChanged(const QItemSelection& selected, const QIte
 void
 TreeView_Impl::handleExpanded(const QModelIndex& index)
 {
+	if (fBatchExpanding) {
+		fBatchIndexes.append(index);
+		return;
+	}
 	QMetaObject::invokeMethod(this, "handleResizeToContents", Qt::QueuedConnection);
 	DataModel_Impl *model = (DataModel_Impl *)this->model();
 	EventRunner runner(this, "onExpand");
@@ -461,6 +467,10 @@ TreeView_Impl::handleExpanded(const QModelIndex& index)
 void
 TreeView_Impl::handleCollapsed(const QModelIndex& index)
 {
+	if (fBatchExpanding) {
+		fBatchIndexes.append(index);
+		return;
+	}
 	QMetaObject::invokeMethod(this, "handleResizeToContents", Qt::QueuedConnection);
 	DataModel_Impl *model = (DataModel_Impl *)this->model();
 	EventRunner runner(this, "onCollapse");
@@ -471,6 +481,291 @@ TreeView_Impl::handleCollapsed(const QModelIndex& index)
 }
 
 
+void
+TreeView_Impl::setExpandedIndexes(const QModelIndexList& indexes, bool expanded, const QModelIndex& root, bool notify)
+{
+	if (indexes.isEmpty())
+		return;
+	
+	fBatchIndexes.clear();
+	fBatchExpanding = true;
+	scheduleDelayedItemsLayout();
+	foreach (QModelIndex index, indexes) {
+		if ((index.isValid()) && (isExpanded(index) != expanded))
+			setExpanded(index, expanded);
+	}
+	fBatchExpanding = false;
+	
+	if ((fBatchIndexes.isEmpty()) || (!notify)) {
+		fBatchIndexes.clear();
+		return;
+	}
+	
+	QMetaObject::invokeMethod(this, "handleResizeToContents", Qt::QueuedConnection);
+	DataModel_Impl *model = (DataModel_Impl *)this->model();
+	EventRunner runner(this, expanded ? "onExpand" : "onCollapse");
+	if (runner.isValid()) {
+		PyObject *tuple = PyTuple_New(fBatchIndexes.size());
+		for (int i = 0; i < fBatchIndexes.size(); i++) {
+			PyObject *dataIndex = model->getDataIndex(fBatchIndexes.at(i));
+			Py_INCREF(dataIndex);
+			PyTuple_SET_ITEM(tuple, i, dataIndex);
+		}
+		runner.set("index", model->getDataIndex(root), false);
+		runner.set("indexes", tuple);
+		runner.run();
+	}
+	fBatchIndexes.clear();
+}
+
+
+void
+TreeView_Impl::expandRecursively(const QModelIndex& root, int depth)
+{
+	DataModel_Impl *model = (DataModel_Impl *)this->model();
+	QModelIndexList level, next, indexes;
+	int i, row, count;
+	
+	if (root.isValid()) {
+		level.append(root);
+	}
+	else {
+		count = model->rowCount();
+		for (row = 0; row < count; row++)
+			level.append(model->index(row, 0));
+	}
+	
+	for (i = 0; (!level.isEmpty()) && ((depth < 0) || (i <= depth)); i++) {
+		model->prefetchRowCounts(level);
+		next.clear();
+		foreach (QModelIndex index, level) {
+			count = model->rowCount(index);
+			if (count <= 0)
+				continue;
+			indexes.append(index);
+			if ((depth < 0) || (i < depth)) {
+				for (row = 0; row < count; row++)
+					next.append(model->index(row, 0, index));
+			}
+		}
+		level = next;
+	}
+	
+	setExpandedIndexes(indexes, true, root);
+}
+
+
+void
+TreeView_Impl::collapseRecursively(const QModelIndex& root)
+{
+	DataModel_Impl *model = (DataModel_Impl *)this->model();
+	QModelIndexList stack, indexes;
+	
+	if (!root.isValid()) {
+		collapseAll();
+		return;
+	}
+	
+	stack.append(root);
+	while (!stack.isEmpty()) {
+		QModelIndex index = stack.takeLast();
+		if (isExpanded(index))
+			indexes.append(index);
+		if (!model->isRowCountKnown(index))
+			continue;
+		int count = model->rowCount(index);
+		for (int row = 0; row < count; row++)
+			stack.append(model->index(row, 0, index));
+	}
+	
+	setExpandedIndexes(indexes, false, root);
+}
+
+
+PyObject *
+TreeView_Impl::saveState()
+{
+	PyAutoLocker locker;
+	DataModel_Impl *model = (DataModel_Impl *)this->model();
+	QModelIndex current = currentIndex();
+	QSet<QModelIndex> currentPath;
+	QList<QPair<QModelIndex, PyObject *> > level, next;
+	PyObject *expanded, *currentKeys = Py_None, *result;
+	int i, row, count;
+	
+	for (QModelIndex index = current.sibling(current.row(), 0); index.isValid(); index = index.parent())
+		currentPath.insert(index);
+	
+	expanded = PySet_New(NULL);
+	if (!expanded)
+		return NULL;
+	Py_INCREF(currentKeys);
+	level.append(qMakePair(QModelIndex(), PyTuple_New(0)));
+	
+	while (!level.isEmpty()) {
+		QModelIndexList children;
+		QList<PyObject *> parentKeys;
+		
+		for (i = 0; i < level.size(); i++) {
+			QModelIndex parent = level.at(i).first;
+			if (model->isRowCountKnown(parent)) {
+				count = model->rowCount(parent);
+				for (row = 0; row < count; row++) {
+					QModelIndex index = model->index(row, 0, parent);
+					if ((isExpanded(index)) || (currentPath.contains(index))) {
+						children.append(index);
+						parentKeys.append(level.at(i).second);
+					}
+				}
+			}
+		}
+		
+		PyObject *keys = children.isEmpty() ? NULL : model->getRowKeys(children);
+		next.clear();
+		for (i = 0; (keys) && (i < children.size()); i++) {
+			PyObject *key = PySequence_Fast_GET_ITEM(keys, i);
+			PyObject *path = PyTuple_Pack(1, key);
+			PyObject *fullPath = PySequence_Concat(parentKeys.at(i), path);
+			Py_DECREF(path);
+			if ((!fullPath) || ((isExpanded(children.at(i))) && (PySet_Add(expanded, fullPath) < 0))) {
+				Py_XDECREF(fullPath);
+				break;
+			}
+			if (children.at(i) == current.sibling(current.row(), 0)) {
+				Py_DECREF(currentKeys);
+				Py_INCREF(fullPath);
+				currentKeys = fullPath;
+			}
+			next.append(qMakePair(children.at(i), fullPath));
+		}
+		Py_XDECREF(keys);
+		
+		for (i = 0; i < level.size(); i++)
+			Py_DECREF(level.at(i).second);
+		level = next;
+		
+		if (PyErr_Occurred()) {
+			for (i = 0; i < level.size(); i++)
+				Py_DECREF(level.at(i).second);
+			Py_DECREF(expanded);
+			Py_DECREF(currentKeys);
+			return NULL;
+		}
+	}
+	
+	PyObject *frozen = PyFrozenSet_New(expanded);
+	Py_DECREF(expanded);
+	PyObject *scroll = frozen ? createVectorObject(QPoint(horizontalScrollBar()->value(), verticalScrollBar()->value())) : NULL;
+	if (!scroll) {
+		Py_XDECREF(frozen);
+		Py_DECREF(currentKeys);
+		return NULL;
+	}
+	
+	result = Py_BuildValue("(NNiN)", frozen, currentKeys, current.isValid() ? current.column() : 0, scroll);
+	return result;
+}
+
+
+bool
+TreeView_Impl::restoreState(PyObject *state)
+{
+	PyAutoLocker locker;
+	DataModel_Impl *model = (DataModel_Impl *)this->model();
+	PyObject *expanded, *currentKeys;
+	QModelIndexList level, indexes;
+	QList<PyObject *> levelKeys;
+	QModelIndex current;
+	QPoint scroll;
+	int column, depth, i, row, count;
+	
+	if (!PyArg_ParseTuple(state, "OOiO&", &expanded, &currentKeys, &column, convertPoint, &scroll))
+		return false;
+	if (!PyAnySet_Check(expanded)) {
+		PyErr_SetString(PyExc_TypeError, "expected set object");
+		return false;
+	}
+	if ((currentKeys != Py_None) && (!PyTuple_Check(currentKeys))) {
+		PyErr_SetString(PyExc_TypeError, "expected tuple object");
+		return false;
+	}
+	
+	level.append(QModelIndex());
+	levelKeys.append(PyTuple_New(0));
+	
+	for (depth = 0; !level.isEmpty(); depth++) {
+		QModelIndexList children, next;
+		QList<PyObject *> parentKeys, nextKeys;
+		
+		model->prefetchRowCounts(level);
+		for (i = 0; i < level.size(); i++) {
+			count = model->rowCount(level.at(i));
+			for (row = 0; row < count; row++) {
+				children.append(model->index(row, 0, level.at(i)));
+				parentKeys.append(levelKeys.at(i));
+			}
+		}
+		
+		PyObject *keys = children.isEmpty() ? NULL : model->getRowKeys(children);
+		for (i = 0; (keys) && (i < children.size()); i++) {
+			PyObject *path = PyTuple_Pack(1, PySequence_Fast_GET_ITEM(keys, i));
+			PyObject *fullPath = PySequence_Concat(parentKeys.at(i), path);
+			Py_DECREF(path);
+			if (!fullPath)
+				break;
+			
+			int found = PySet_Contains(expanded, fullPath);
+			bool onPath = false;
+			if ((found >= 0) && (currentKeys != Py_None) && (PyTuple_GET_SIZE(currentKeys) > depth)) {
+				PyObject *prefix = PyTuple_GetSlice(currentKeys, 0, depth + 1);
+				int equal = PyObject_RichCompareBool(prefix, fullPath, Py_EQ);
+				Py_DECREF(prefix);
+				if ((equal > 0) && (PyTuple_GET_SIZE(currentKeys) == depth + 1))
+					current = children.at(i);
+				onPath = (equal > 0);
+				if (equal < 0)
+					found = -1;
+			}
+			if (found < 0) {
+				Py_DECREF(fullPath);
+				break;
+			}
+			if (found)
+				indexes.append(children.at(i));
+			if ((found) || (onPath)) {
+				next.append(children.at(i));
+				nextKeys.append(fullPath);
+			}
+			else
+				Py_DECREF(fullPath);
+		}
+		Py_XDECREF(keys);
+		
+		foreach (PyObject *object, levelKeys)
+			Py_DECREF(object);
+		level = next;
+		levelKeys = nextKeys;
+		
+		if (PyErr_Occurred()) {
+			foreach (PyObject *object, levelKeys)
+				Py_DECREF(object);
+			return false;
+		}
+	}
+	
+	setExpandedIndexes(indexes, true, QModelIndex(), false);
+	executeDelayedItemsLayout();
+	
+	if (current.isValid()) {
+		current = current.sibling(current.row(), column);
+		selectionModel()->setCurrentIndex(current, QItemSelectionModel::NoUpdate);
+	}
+	horizontalScrollBar()->setValue(scroll.x());
+	verticalScrollBar()->setValue(scroll.y());
+	return true;
+}
+
+
 
 void
 TreeView_Impl::restartEdit(const QModelIndex& index, int position)
@@ -721,6 +1016,90 @@ SL_DEFINE_METHOD(TreeView, set_expanded, {
 })
 
 
+SL_DEFINE_METHOD(TreeView, expand_all, {
+	PyObject *object;
+	int depth;
+	
+	if (!PyArg_ParseTuple(args, "Oi", &object, &depth))
+		return NULL;
+	
+	DataModel_Impl *model = (DataModel_Impl *)impl->model();
+	QModelIndex index = model->index(object);
+	if (PyErr_Occurred())
+		return NULL;
+	
+	impl->expandRecursively(index, depth);
+})
+
+
+SL_DEFINE_METHOD(TreeView, collapse_all, {
+	PyObject *object;
+	
+	if (!PyArg_ParseTuple(args, "O", &object))
+		return NULL;
+	
+	DataModel_Impl *model = (DataModel_Impl *)impl->model();
+	QModelIndex index = model->index(object);
+	if (PyErr_Occurred())
+		return NULL;
+	
+	impl->collapseRecursively(index);
+})
+
+
+SL_DEFINE_METHOD(TreeView, expand_indexes, {
+	PyObject *object, *sequence;
+	Py_ssize_t size, i;
+	bool expanded;
+	QModelIndexList indexes;
+	
+	if (!PyArg_ParseTuple(args, "OO&", &object, convertBool, &expanded))
+		return NULL;
+	
+	DataModel_Impl *model = (DataModel_Impl *)impl->model();
+	sequence = PySequence_Fast(object, "expected sequence object");
+	if (!sequence)
+		return NULL;
+	
+	size = PySequence_Fast_GET_SIZE(sequence);
+	for (i = 0; i < size; i++) {
+		PyObject *item = PySequence_Fast_GET_ITEM(sequence, i);
+		QModelIndex index;
+		
+		if (!PyObject_TypeCheck(item, (PyTypeObject *)PyDataIndex_Type))
+			PyErr_SetString(PyExc_ValueError, "expected DataIndex object");
+		else
+			index = model->index(item);
+		if (PyErr_Occurred()) {
+			Py_DECREF(sequence);
+			return NULL;
+		}
+		indexes.append(index);
+	}
+	Py_DECREF(sequence);
+	
+	if (expanded)
+		model->prefetchRowCounts(indexes);
+	impl->setExpandedIndexes(indexes, expanded);
+})
+
+
+SL_DEFINE_METHOD(TreeView, get_view_state, {
+	return impl->saveState();
+})
+
+
+SL_DEFINE_METHOD(TreeView, set_view_state, {
+	PyObject *state;
+	
+	if (!PyArg_ParseTuple(args, "O!", &PyTuple_Type, &state))
+		return NULL;
+	
+	if (!impl->restoreState(state))
+		return NULL;
+})
+
+
 SL_DEFINE_METHOD(TreeView, is_expanded, {
 	PyObject *object;
 	
@@ -819,6 +1198,8 @@ SL_DEFINE_METHOD(TreeView, get_style, {
 		style |= SL_TREEVIEW_STYLE_EXPANDERS;
 	if (impl->showRules())
 		style |= SL_TREEVIEW_STYLE_RULES;
+	if (impl->uniformRowHeights())
+		style |= SL_TREEVIEW_STYLE_UNIFORM_ROWS;
 	
 	return PyInt_FromLong(style);
 })
@@ -841,6 +1222,7 @@ SL_DEFINE_METHOD(TreeView, set_style, {
 	impl->setShowExpanders(style & SL_TREEVIEW_STYLE_EXPANDERS ? true : false);
 	impl->setShowRules(style & SL_TREEVIEW_STYLE_RULES ? true : false);
 	impl->header()->setStretchLastSection(!(style & SL_TREEVIEW_STYLE_FIT_COLS));
+	impl->setUniformRowHeights(style & SL_TREEVIEW_STYLE_UNIFORM_ROWS ? true : false);
 	impl->update();
 })
 
@@ -863,6 +1245,11 @@ SL_DEFINE_METHOD(TreeView, set_indentation, {
 SL_START_VIEW_PROXY(TreeView)
 SL_METHOD(edit)
 SL_METHOD(set_expanded)
+SL_METHOD(expand_all)
+SL_METHOD(collapse_all)
+SL_METHOD(expand_indexes)
+SL_METHOD(get_view_state)
+SL_METHOD(set_view_state)
 SL_METHOD(is_expanded)
 SL_METHOD(set_span_first_column)
 SL_METHOD(complete)
@@ -39,6 +39,13 @@ public:
 	
 	void redrawBranches(QPainter *painter, const QModelIndex& index) { drawBranches(painter, fLastBranchesRect, index); }
 	
+	void setExpandedIndexes(const QModelIndexList& indexes, bool expanded, const QModelIndex& root = QModelIndex(), bool notify = true);
+	void expandRecursively(const QModelIndex& root, int depth = -1);
+	void collapseRecursively(const QModelIndex& root);
+	
+	PyObject *saveState();
+	bool restoreState(PyObject *state);
+	
 	virtual void setModel(QAbstractItemModel *model);
 	virtual QModelIndex indexAt(const QPoint& point) const;
 	virtual QRect visualRect(const QModelIndex& index) const;
@@ -84,6 +91,8 @@ private:
 	int						fExpandFrame;
 	QPersistentModelIndex	fEditIndex;
 	QRect					fLastBranchesRect;
+	bool					fBatchExpanding;
+	QModelIndexList			fBatchIndexes;
 };
 
 
@@ -97,59 +97,194 @@ WidgetInterface::canModify(QWidget *widget)
 }
 
 
-bool
-EventRunner::run()
+static bool
+isDefaultHandler(PyObject *name, PyObject *func)
 {
-	bool success = true;
-	
-	if ((!fProxy) || (!fProxy->fWidget))
-		return true;
+	if ((!PyEventHandler_Type) || (!PyType_Check(PyEventHandler_Type)))
+		return false;
+	if (_PyType_Lookup((PyTypeObject *)PyEventHandler_Type, name) != func)
+		return false;
 	
-	PyObject *widget = PyWeakref_GetObject(fProxy->fWidget);
-	if ((!widget) || (widget == Py_None)) {
+	// EventHandler marks the defaults that can be skipped, the ones returning False still need to run
+	PyObject *marker = PyObject_GetAttrString(func, "default_handler");
+	if (!marker) {
 		PyErr_Clear();
-		return true;
+		return false;
 	}
-	Py_INCREF(widget);
-	PyObject *handler = PyObject_CallMethod(widget, "get_handler", NULL);
+	bool result = PyObject_IsTrue(marker) == 1;
+	Py_DECREF(marker);
+	return result;
+}
+
+
+static PyObject *
+bindMethod(PyObject *func, PyObject *handler)
+{
+	descrgetfunc get = Py_TYPE(func)->tp_descr_get;
+	if (!get) {
+		Py_INCREF(func);
+		return func;
+	}
+	PyObject *method = get(func, handler, (PyObject *)Py_TYPE(handler));
+	if (!method)
+		PyErr_Clear();
+	return method;
+}
+
+
+void
+HandlerCache::reset()
+{
+	foreach (const Entry& entry, fMethods) {
+		Py_XDECREF(entry.fFunc);
+	}
+	fMethods.clear();
+	Py_CLEAR(fHandler);
+	fType = NULL;
+	fVersion = 0;
+}
+
+
+PyObject *
+HandlerCache::getHandler(PyObject *widget)
+{
+	PyObject *handler;
+	
+	if (fHandler) {
+		handler = PyWeakref_GET_OBJECT(fHandler);
+		if (handler != Py_None) {
+			Py_INCREF(handler);
+			return handler;
+		}
+		Py_CLEAR(fHandler);
+	}
+	
+	handler = PyObject_CallMethod(widget, "get_handler", NULL);
 	if ((!handler) || (handler == Py_None)) {
+		PyErr_Clear();
+		Py_XDECREF(handler);
 		handler = widget;
 		Py_INCREF(handler);
 	}
-	Py_DECREF(widget);
+	fHandler = PyWeakref_NewRef(handler, NULL);
+	if (!fHandler)
+		PyErr_Clear();
+	return handler;
+}
+
+
+PyObject *
+HandlerCache::getMethod(PyObject *handler, const QByteArray& name, bool *overridden)
+{
+	PyTypeObject *type = Py_TYPE(handler);
+	PyObject *func, **dictPtr, *nameObj;
 	
-	PyObject *method = PyObject_GetAttrString(handler, fName.toUtf8());
-	if (method) {
-		PyObject *result = NULL;
-		Py_XDECREF(fEvent);
-		
-		PyObject *now = createDateTimeObject(QDateTime::currentDateTime());
-		PyObject *posArgs = PyTuple_New(0);
-		PyDict_SetItemString(fParams, "widget", widget);
-		PyDict_SetItemString(fParams, "time", now);
-		fEvent = PyObject_Call(PyEvent_Type, posArgs, fParams);
-		Py_DECREF(posArgs);
-		Py_DECREF(now);
-		
-		if (fEvent) {
-			result = PyObject_CallFunctionObjArgs(method, fEvent, NULL);
-		}
-		Py_DECREF(method);
-		
-		if (!result) {
-			PyErr_Print();
+	*overridden = true;
+	if ((type->tp_getattro != PyObject_GenericGetAttr) || (!PyType_HasFeature(type, Py_TPFLAGS_HAVE_VERSION_TAG))) {
+		func = PyObject_GetAttrString(handler, name.constData());
+		if (!func)
 			PyErr_Clear();
-			success = false;
+		return func;
+	}
+	
+	// per-instance overrides as set by EventProperty
+	dictPtr = _PyObject_GetDictPtr(handler);
+	if ((dictPtr) && (*dictPtr)) {
+		func = PyDict_GetItemString(*dictPtr, name.constData());
+		if (func) {
+			Py_INCREF(func);
+			return func;
 		}
-		else {
-			success = ((result == Py_None) || (PyObject_IsTrue(result)));
-			Py_DECREF(result);
+	}
+	
+	if ((fType != type) || (!PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) || (type->tp_version_tag != fVersion)) {
+		foreach (const Entry& entry, fMethods) {
+			Py_XDECREF(entry.fFunc);
 		}
+		fMethods.clear();
+		fType = NULL;
 	}
 	else {
+		QHash<QByteArray, Entry>::const_iterator it = fMethods.constFind(name);
+		if (it != fMethods.constEnd()) {
+			*overridden = it.value().fOverridden;
+			return it.value().fFunc ? bindMethod(it.value().fFunc, handler) : NULL;
+		}
+	}
+	
+	nameObj = PyString_FromStringAndSize(name.constData(), name.size());
+	if (!nameObj) {
 		PyErr_Clear();
+		return NULL;
+	}
+	func = _PyType_Lookup(type, nameObj);
+	*overridden = (func) && (!isDefaultHandler(nameObj, func));
+	Py_DECREF(nameObj);
+	
+	if (PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+		Entry entry = { func, *overridden };
+		Py_XINCREF(func);
+		fMethods.insert(name, entry);
+		fType = type;
+		fVersion = type->tp_version_tag;
+	}
+	return func ? bindMethod(func, handler) : NULL;
+}
+
+
+bool
+EventRunner::resolve()
+{
+	if (fResolved)
+		return fMethod != NULL;
+	fResolved = true;
+	
+	if ((!isValid()) || (!fProxy->fWidget))
+		return false;
+	
+	PyObject *widget = PyWeakref_GetObject(fProxy->fWidget);
+	if ((!widget) || (widget == Py_None)) {
+		PyErr_Clear();
+		return false;
+	}
+	if (!fProxy->fHandlers)
+		fProxy->fHandlers = new HandlerCache();
+	
+	fHandler = fProxy->fHandlers->getHandler(widget);
+	fMethod = fProxy->fHandlers->getMethod(fHandler, fName.toUtf8(), &fOverridden);
+	return fMethod != NULL;
+}
+
+
+bool
+EventRunner::run()
+{
+	bool success = true;
+	
+	if (!resolve())
+		return true;
+	
+	PyObject *widget = PyWeakref_GetObject(fProxy->fWidget);
+	PyObject *result = NULL;
+	Py_XDECREF(fEvent);
+	
+	PyDict_SetItemString(fParams, "widget", widget);
+	fFields.insert("time", QDateTime::currentDateTime());
+	fEvent = createEventObject(fParams, fFields);
+	
+	if (fEvent) {
+		result = PyObject_CallFunctionObjArgs(fMethod, fEvent, NULL);
+	}
+	
+	if (!result) {
+		PyErr_Print();
+		PyErr_Clear();
+		success = false;
+	}
+	else {
+		success = ((result == Py_None) || (PyObject_IsTrue(result)));
+		Py_DECREF(result);
 	}
-	Py_DECREF(handler);
 	
 	return success;
 }
@@ -480,6 +480,33 @@ SL_DEFINE_METHOD(Window, set_timeout, {
 })
 
 
+SL_DEFINE_METHOD(Window, set_interval, {
+	Py_ssize_t size = PyTuple_Size(args);
+	if (PyErr_Occurred())
+		return NULL;
+	
+	if (size < 1) {
+		PyErr_SetString(PyExc_ValueError, "missing parameter(s)");
+		return NULL;
+	}
+	
+	int interval = PyInt_AsLong(PyTuple_GetItem(args, 0));
+	if (PyErr_Occurred())
+		return NULL;
+	
+	if (interval <= 0) {
+		SL_QAPP()->timerWheel()->cancelOwner(impl);
+	}
+	else {
+		PyObject *func_args = PyTuple_GetSlice(args, 1, size);
+		
+		setTimeout(impl, interval, NULL, func_args, true);
+		
+		Py_DECREF(func_args);
+	}
+})
+
+
 SL_DEFINE_METHOD(Window, fit, {
 	if (impl->layout()) {
 		impl->layout()->activate();
@@ -1048,6 +1075,7 @@ SL_METHOD(popup_message)
 SL_METHOD(find_focus)
 SL_METHOD(set_shortcut)
 SL_METHOD(set_timeout)
+SL_METHOD(set_interval)
 SL_METHOD(fit)
 SL_METHOD(render)
 SL_METHOD(get_system_color)
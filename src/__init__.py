@@ -435,6 +435,12 @@ class DataModel(object):
 	def has_children(self, index=None):
 		pass
 	
+	def child_counts(self, indexes):
+		return [ self.row_count(index) for index in indexes ]
+	
+	def row_keys(self, indexes):
+		return [ index.row for index in indexes ]
+	
 	def set_data(self, index, value):
 		pass
 	
@@ -688,7 +694,7 @@ def exit():
 
 
 
-def load_resource(resource):
+def resolve_resource(resource):
 	global sArchiveDict
 	if sArchiveDict is None:
 		sArchiveDict = {}
@@ -704,8 +710,12 @@ def load_resource(resource):
 	if resource.startswith("resource:"):
 		resource = resource[9:]
 	resource = resource.strip()
-	if resource in sArchiveDict:
-		resource = sArchiveDict[resource]
+	return sArchiveDict.get(resource, resource)
+
+
+
+def load_resource(resource):
+	resource = resolve_resource(resource)
 	try:
 # 		print "attempting to load resource:", resource
 		return get_backend().load_resource(resource)
@@ -719,6 +729,16 @@ def load_resource(resource):
 
 
 
+def load_bitmap(resource, size=None):
+	resource = resolve_resource(resource)
+	size = Vector.ensure(size)
+	bitmap = get_backend().lookup_bitmap(resource, size)
+	if bitmap is None:
+		bitmap = get_backend().store_bitmap(resource, load_resource(resource), size)
+	return bitmap
+
+
+
 def load_interface(resource):
 	node = parse_xml(load_resource(resource))
 	if node.tag != 'interface':
@@ -834,7 +854,67 @@ def call_later(func, *args):
 
 
 def call_later_timeout(timeout, func, *args):
-	get_backend().call_later_timeout(timeout, func, *args)
+	return get_backend().call_later_timeout(timeout, func, *args)
+
+
+
+def call_later_interval(interval, func, *args):
+	return get_backend().call_later_interval(interval, func, *args)
+
+
+
+def cancel_timer(id):
+	return get_backend().cancel_timer(id)
+
+
+
+def get_pending_timers():
+	return get_backend().get_pending_timers()
+
+
+
+def run_in_background(func, args=(), on_done=None, on_error=None, on_progress=None):
+	return get_backend().run_in_background(func, args, on_done, on_error, on_progress)
+
+
+
+def get_current_task():
+	return get_backend().get_current_task()
+
+
+
+def set_background_concurrency(count):
+	get_backend().set_background_concurrency(count)
+
+
+
+def get_background_concurrency():
+	return get_backend().get_background_concurrency()
+
+
+
+def set_decode_concurrency(count):
+	get_backend().set_decode_concurrency(count)
+
+
+
+def get_decode_concurrency():
+	return get_backend().get_decode_concurrency()
+
+
+
+def set_image_cache_limit(limit):
+	get_backend().set_image_cache_limit(limit)
+
+
+
+def get_image_cache_stats(reset=False):
+	return get_backend().get_image_cache_stats(reset)
+
+
+
+def clear_image_cache():
+	get_backend().clear_image_cache()
 
 
 
@@ -863,6 +943,26 @@ def set_keyboard_repeat_rate(rate):
 
 
 
+def set_event_coalescing(interval):
+	get_backend().set_event_coalescing(interval)
+
+
+
+def get_event_coalescing_stats(reset=False):
+	return get_backend().get_event_coalescing_stats(reset)
+
+
+
+def set_call_queue_budget(msecs):
+	get_backend().set_call_queue_budget(msecs)
+
+
+
+def get_call_queue_stats(reset=False):
+	return get_backend().get_call_queue_stats(reset)
+
+
+
 def process_events():
 	get_backend().process_events()
 
@@ -7,10 +7,15 @@ from numbers import Number
 
 
 class Vector(object):
+	__slots__ = ('x', 'y')
+	
 	def __init__(self, x=0.0, y=0.0):
 		self.x = float(x)
 		self.y = float(y)
 	
+	def __reduce__(self):
+		return (Vector, (self.x, self.y))
+	
 	class XDescriptor(object):
 		def __get__(self, instance, owner):
 			return instance.x
@@ -168,6 +173,8 @@ class Color(object):
 # 			instance.a = (value >> 24) & 0xFF
 # 	rgb = RGBDescriptor()
 	
+	__slots__ = ('r', 'g', 'b', 'a')
+	
 	def __init__(self, r=0, g=0, b=0, a=255, value=None):
 		if value is not None:
 			if isinstance(value, (tuple, list)):
@@ -228,6 +235,9 @@ class Color(object):
 		self.b = b
 		self.a = a
 	
+	def __reduce__(self):
+		return (Color, (self.r, self.g, self.b, self.a))
+	
 	def gray(self, intensity=255):
 		hue = (((self.r * 11) + (self.g * 16) + (self.b * 5)) * intensity) / 8160
 		return Color(hue, hue, hue, self.a)
@@ -294,6 +304,8 @@ class Font(object):
 	
 	STYLES = [ "bold", "italic", "underlined", "nokerning" ]
 	
+	__slots__ = ('family', 'face', 'size', 'style', 'spacing')
+	
 	def __init__(self, family=0, face="", size=SIZE_DEFAULT, style=0, spacing=0, string=None):
 		self.family = family
 		self.face = face
@@ -315,6 +327,9 @@ class Font(object):
 				elif key == 'spacing':
 					self.spacing = int(value)
 	
+	def __reduce__(self):
+		return (Font, (self.family, self.face, self.size, self.style, self.spacing))
+	
 	def __str__(self):
 		s = "family:" + Font.FAMILIES[self.family]
 		if self.face:
@@ -587,9 +602,10 @@ class PrintDC(DC):
 
 class Bitmap(DC):
 	def __init__(self, data=None, resource=None, size=None, bits=None):
-		self._impl = slew.get_backend().Bitmap(Vector.ensure(size) or Vector(32,32))
 		if resource is not None:
-			data = slew.load_resource(resource)
+			self._impl = slew.load_bitmap(resource)._impl
+			return
+		self._impl = slew.get_backend().Bitmap(Vector.ensure(size) or Vector(32,32))
 		if data is not None:
 			self.load(data)
 		elif bits is not None:
@@ -607,15 +623,44 @@ class Bitmap(DC):
 	def colorized(self, color):
 		return self._impl.colorized(Color.ensure(color, False))
 	
+	def grayscaled(self):
+		return self._impl.grayscaled()
+	
+	def premultiplied(self):
+		return self._impl.premultiplied()
+	
+	def adjusted(self, brightness=0, contrast=1.0):
+		return self._impl.adjusted(int(brightness), float(contrast))
+	
+	def swizzled(self, order):
+		return self._impl.swizzled(order)
+	
+	def blurred(self, radius):
+		return self._impl.blurred(int(radius))
+	
 	def load(self, data):
 		self._impl.load(data)
 	
 	def save(self):
 		return self._impl.save()
 	
+	@staticmethod
+	def load_async(data, callback, target_size=None):
+		return slew.get_backend().load_bitmap_async(data, Vector.ensure(target_size), callback)
+	
 	def copy(self):
 		return self._impl.copy()
 	
+	def lock(self):
+		self._impl.lock()
+		return memoryview(self._impl)
+	
+	def unlock(self):
+		self._impl.unlock()
+	
+	def is_locked(self):
+		return self._impl.is_locked()
+	
 	def __getstate__(self):
 		return bytes(self._impl.save())
 	
@@ -24,6 +24,7 @@ class Grid(View):
 	STYLE_NO_SELECTION			= 0x02000000
 	STYLE_DELAYED_EDIT			= 0x04000000
 	STYLE_AUTO_SCROLL			= 0x08000000
+	STYLE_UNIFORM_ROWS			= 0x10000000
 	#}
 	
 	PROPERTIES = merge(View.PROPERTIES, {
@@ -41,6 +42,7 @@ class Grid(View):
 									'noselection':			STYLE_NO_SELECTION,
 									'delayedit':			STYLE_DELAYED_EDIT,
 									'autoscroll':			STYLE_AUTO_SCROLL,
+									'uniformrows':			STYLE_UNIFORM_ROWS,
 								})),
 		'row':					IntProperty(),
 		'column':				IntProperty(),
@@ -24,6 +24,7 @@ class TreeView(View):
 	STYLE_ALT_ROWS				= 0x01000000
 	STYLE_READONLY				= 0x02000000
 	STYLE_FIT_COLS				= 0x04000000
+	STYLE_UNIFORM_ROWS			= 0x08000000
 	#}
 	
 	PROPERTIES = merge(View.PROPERTIES, {
@@ -40,6 +41,7 @@ class TreeView(View):
 									'altrows':				STYLE_ALT_ROWS,
 									'readonly':				STYLE_READONLY,
 									'fitcols':				STYLE_FIT_COLS,
+									'uniformrows':			STYLE_UNIFORM_ROWS,
 								})),
 	})
 	
@@ -50,11 +52,12 @@ class TreeView(View):
 	
 	def set_expanded(self, index, expanded, recursive=False):
 		index = slew.DataIndex.ensure(index)
-		model = self.get_model()
-		self._impl.set_expanded(index, expanded)
-		if recursive and model:
-			for row in xrange(0, model.row_count(index)):
-				self.set_expanded(model.index(row, 0, index), expanded, True)
+		if not recursive:
+			self._impl.set_expanded(index, expanded)
+		elif expanded:
+			self._impl.expand_all(index, -1)
+		else:
+			self._impl.collapse_all(index)
 	
 	def is_expanded(self, index):
 		return self._impl.is_expanded(slew.DataIndex.ensure(index, False))
@@ -65,11 +68,20 @@ class TreeView(View):
 	def collapse(self, index=None, children=False):
 		self.set_expanded(index, False, children)
 	
-	def expand_all(self, index=None):
-		self.set_expanded(index, True, True)
+	def expand_all(self, index=None, depth=-1):
+		self._impl.expand_all(slew.DataIndex.ensure(index), depth)
 	
 	def collapse_all(self, index=None):
-		self.set_expanded(index, False, True)
+		self._impl.collapse_all(slew.DataIndex.ensure(index))
+	
+	def expand_indexes(self, indexes, expand=True):
+		self._impl.expand_indexes(tuple(indexes), expand)
+	
+	def get_view_state(self):
+		return self._impl.get_view_state()
+	
+	def set_view_state(self, state):
+		self._impl.set_view_state(state)
 	
 	def set_span_first_column(self, row, enabled, parent=None):
 		self._impl.set_span_first_column(row, enabled, slew.DataIndex.ensure(parent))
@@ -388,7 +388,7 @@ class FloatProperty(Property):
 class BitmapProperty(Property):
 	def load(self, instance, name, node, globals, locals):
 		if name in node.attrib:
-			getattr(instance, 'set_' + name)(Bitmap(data=slew.load_resource(node.attrib[name])))
+			getattr(instance, 'set_' + name)(slew.load_bitmap(node.attrib[name]))
 
 
 
@@ -399,10 +399,10 @@ class IconProperty(Property):
 			for part in node.attrib[name].split(','):
 				desc = part.split(':')
 				if len(desc) == 1:
-					pixmap['normal'] = Bitmap(data=slew.load_resource(desc[0].strip()))
+					pixmap['normal'] = slew.load_bitmap(desc[0])
 				else:
 					type, res = desc
-					pixmap[type.strip()] = Bitmap(data=slew.load_resource(res.strip()))
+					pixmap[type.strip()] = slew.load_bitmap(res)
 			getattr(instance, 'set_' + name)(Icon(pixmap.get('normal'), pixmap.get('disabled'), pixmap.get('active'), pixmap.get('selected')))
 
 
@@ -45,6 +45,8 @@ class EventHandler(object):
 	
 	def set_handler(self, handler):
 		self.__handler = handler
+		if '_impl' in self.__dict__:
+			slew.get_backend().reset_handlers(self)
 	
 	def onTimer(self, e):				pass
 	def onPaint(self, e):				pass
@@ -97,6 +99,9 @@ class EventHandler(object):
 for name in dir(EventHandler):
 	if name.startswith('on'):
 		EventHandler.PROPERTIES[name] = EventProperty()
+		# empty defaults; the backend skips building events for handlers that don't override them
+		if name not in ('onDragStart', 'onDragMove', 'onContextMenu'):
+			getattr(EventHandler, name).im_func.default_handler = True
 
 
 
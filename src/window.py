@@ -220,6 +220,9 @@ class Window(Layoutable):
 	def set_timeout(self, msecs, *args):
 		self._impl.set_timeout(msecs, *args)
 	
+	def set_interval(self, msecs, *args):
+		self._impl.set_interval(msecs, *args)
+	
 	def fit(self):
 		self._impl.fit()
 		return self.get_size()
@@ -0,0 +1,83 @@
+"""
+Micro-benchmark for the Bitmap pixel kernels.
+
+Times every kernel through its SIMD and scalar code paths and, where Qt has one, through the
+equivalent QImage/QPainter operation. Fails if the SIMD and scalar paths produce different
+pixels. Then times the public Bitmap methods, which include the pixmap to image conversions.
+Results are written as JSON.
+
+Usage:
+	QT_QPA_PLATFORM=offscreen python benchmark_bitmap.py [--width N] [--height N]
+		[--iterations N] [--output file.json]
+"""
+
+import os
+import time
+import json
+import optparse
+
+os.environ.setdefault('QT_QPA_PLATFORM', 'offscreen')
+
+import slew
+
+
+
+class Benchmark(slew.Application):
+	def __init__(self, options):
+		self.options = options
+
+	def run(self):
+		slew.call_later(self.execute)
+
+	def measure(self, func):
+		times = []
+		for i in xrange(self.options.iterations):
+			start = time.time()
+			func()
+			times.append((time.time() - start) * 1000.0)
+		return sum(times) / len(times)
+
+	def execute(self):
+		try:
+			options = self.options
+			size = (options.width, options.height)
+			results = {
+				'size':			size,
+				'iterations':	options.iterations,
+				'kernels':		slew.get_backend().benchmark_pixel_kernels(slew.Vector(*size), options.iterations),
+			}
+			for name, kernel in results['kernels'].iteritems():
+				if isinstance(kernel, dict):
+					assert kernel['match'], 'SIMD and scalar %s kernels differ' % name
+			bitmap = slew.Bitmap(size=size)
+			bitmap.set_color(slew.Color(255, 128, 0))
+			bitmap.set_bgcolor(slew.Color(40, 80, 160, 200))
+			bitmap.rect((0, 0), size)
+
+			results['methods'] = {
+				'grayscaled':		self.measure(lambda: bitmap.grayscaled()),
+				'premultiplied':	self.measure(lambda: bitmap.premultiplied()),
+				'colorized':		self.measure(lambda: bitmap.colorized(slew.Color(255, 128, 0))),
+				'adjusted':			self.measure(lambda: bitmap.adjusted(20, 1.25)),
+				'swizzled':			self.measure(lambda: bitmap.swizzled('BGRA')),
+				'blurred':			self.measure(lambda: bitmap.blurred(4)),
+			}
+			data = json.dumps(results, indent=1)
+			if options.output:
+				f = open(options.output, 'w')
+				f.write(data)
+				f.close()
+			else:
+				print data
+		finally:
+			slew.exit()
+
+
+
+parser = optparse.OptionParser()
+parser.add_option('--width', type='int', default=1920)
+parser.add_option('--height', type='int', default=1080)
+parser.add_option('--iterations', type='int', default=20)
+parser.add_option('--output', default='')
+
+slew.run(Benchmark(parser.parse_args()[0]))
@@ -0,0 +1,215 @@
+"""
+Offscreen rendering benchmark for item views.
+
+Builds synthetic data models of configurable size and measures first paint,
+page scrolling, resize, model reset, bulk insert and sort on Grid, TreeView
+and ListView. Results are written as JSON, one record per view/operation.
+
+Usage:
+	QT_QPA_PLATFORM=offscreen python benchmark_views.py [--rows N] [--columns N] [--children N]
+		[--pages N] [--views grid,treeview,listview] [--output file.json]
+"""
+
+import os
+import sys
+import time
+import json
+import optparse
+
+os.environ.setdefault('QT_QPA_PLATFORM', 'offscreen')
+
+import slew
+
+try:
+	import resource
+except ImportError:
+	resource = None
+
+
+
+def peak_memory():
+	if resource is None:
+		return None
+	usage = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+	if sys.platform == 'darwin':
+		usage /= 1024
+	return usage
+
+
+
+class Counters(object):
+	def __init__(self):
+		self.reset()
+
+	def reset(self):
+		self.calls = {}
+
+	def hit(self, name):
+		self.calls[name] = self.calls.get(name, 0) + 1
+
+	def total(self):
+		return sum(self.calls.itervalues())
+
+
+
+class Model(slew.DataModel):
+	def __init__(self, counters, rows, columns, children=0):
+		self.counters = counters
+		self.rows = range(rows)
+		self.columns = columns
+		self.children = children
+
+	def row_count(self, index=None):
+		self.counters.hit('row_count')
+		if index is None:
+			return len(self.rows)
+		if (index.parent is None) and (self.children > 0):
+			return self.children
+		return 0
+
+	def column_count(self):
+		self.counters.hit('column_count')
+		return self.columns
+
+	def has_children(self, index=None):
+		self.counters.hit('has_children')
+		if index is None:
+			return len(self.rows) > 0
+		return (index.parent is None) and (self.children > 0)
+
+	def header(self, pos):
+		self.counters.hit('header')
+		if pos.x < 0:
+			return slew.DataSpecifier(text=str(pos.y))
+		return slew.DataSpecifier(text='Column %d' % pos.x, width=80)
+
+	def data(self, index):
+		self.counters.hit('data')
+		if index.parent is None:
+			row = self.rows[index.row]
+		else:
+			row = index.parent.row * 1000 + index.row
+		return slew.DataSpecifier(text='%c-%d' % (65 + (index.column % 26), row))
+
+	def insert(self, count):
+		first = len(self.rows)
+		self.rows.extend(xrange(first, first + count))
+		self.notify(slew.DataModel.NOTIFY_ADDED_ROWS, first, count)
+
+	def sort(self, ascending):
+		self.rows.sort(reverse=not ascending)
+		self.notify(slew.DataModel.NOTIFY_CHANGED_ROWS, 0, len(self.rows))
+
+
+
+class Benchmark(slew.Application):
+	VIEWS = {
+		'grid':			slew.Grid,
+		'treeview':		slew.TreeView,
+		'listview':		slew.ListView,
+	}
+
+	def __init__(self, options):
+		self.options = options
+		self.counters = Counters()
+		self.results = []
+
+	def run(self):
+		slew.call_later(self.execute)
+
+	def flush(self):
+		slew.process_events()
+		slew.flush_events()
+		slew.process_events()
+
+	def measure(self, view, operation, func, frames=1):
+		times = []
+		self.counters.reset()
+		for frame in xrange(frames):
+			start = time.time()
+			func(frame)
+			self.flush()
+			times.append((time.time() - start) * 1000.0)
+		self.results.append({
+			'view':			view,
+			'operation':	operation,
+			'rows':			self.options.rows,
+			'columns':		self.options.columns,
+			'frames':		frames,
+			'frame_ms':		times,
+			'total_ms':		sum(times),
+			'callbacks':	self.counters.total(),
+			'callbacks_by_name':	dict(self.counters.calls),
+			'peak_rss_kb':	peak_memory(),
+		})
+
+	def scroll_page(self, view, frame):
+		pos = view.get_scroll_pos()
+		height = view.get_viewport_size().y
+		view.set_scroll_pos((pos.x, pos.y + height))
+
+	def bench_view(self, name):
+		options = self.options
+		model = Model(self.counters, options.rows, options.columns, options.children if name == 'treeview' else 0)
+		frame = slew.Frame(title='benchmark')
+		frame.set_size((800, 600))
+		view = self.VIEWS[name]()
+		frame.append(slew.VBox().append(view))
+
+		def first_paint(i):
+			view.set_model(model)
+			frame.show()
+
+		def resize(i):
+			if i % 2:
+				frame.set_size((800, 600))
+			else:
+				frame.set_size((1024, 768))
+
+		def reset(i):
+			model.notify(slew.DataModel.NOTIFY_RESET)
+
+		def insert(i):
+			model.insert(options.insert)
+
+		def sort(i):
+			if name == 'grid':
+				view.set_sorting(0, bool(i % 2))
+			model.sort(bool(i % 2))
+
+		self.measure(name, 'first_paint', first_paint)
+		self.measure(name, 'scroll_page', lambda i: self.scroll_page(view, i), options.pages)
+		self.measure(name, 'resize', resize, 4)
+		self.measure(name, 'reset', reset)
+		self.measure(name, 'bulk_insert', insert)
+		self.measure(name, 'sort', sort, 2)
+
+		frame.close()
+		self.flush()
+
+	def execute(self):
+		try:
+			for name in self.options.views.split(','):
+				self.bench_view(name.strip())
+			data = json.dumps(self.results, indent=1)
+			if self.options.output:
+				f = open(self.options.output, 'w')
+				f.write(data)
+				f.close()
+			else:
+				print data
+		finally:
+			slew.exit()
+
+
+
+parser = optparse.OptionParser()
+parser.add_option('--rows', type='int', default=10000)
+parser.add_option('--columns', type='int', default=8)
+parser.add_option('--children', type='int', default=5)
+parser.add_option('--insert', type='int', default=1000)
+parser.add_option('--pages', type='int', default=20)
+parser.add_option('--views', default='grid,treeview,listview')
+parser.add_option('--output', default='')
+
+slew.run(Benchmark(parser.parse_args()[0]))